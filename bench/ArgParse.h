@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Cache
+{
+namespace Bench
+{
+
+// 解析逗号分隔的列表 如 "1,2,4"
+template<typename T>
+std::vector<T> parseList(const std::string& text)
+{
+    std::vector<T> values;
+    std::stringstream stream(text);
+    std::string item;
+    while(std::getline(stream, item, ','))
+    {
+        std::stringstream itemStream(item);
+        T value;
+        if(itemStream >> value)
+            values.push_back(value);
+    }
+    return values;
+}
+
+// min:max:steps -> 按对数等间距取steps个容量(去重 升序)
+inline std::vector<size_t> parseCapacityRange(const std::string& text)
+{
+    std::vector<size_t> capacities;
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string item;
+    while(std::getline(stream, item, ':'))
+        parts.push_back(item);
+    if(parts.size() != 3)
+        return capacities;
+    double low = std::stod(parts[0]);
+    double high = std::stod(parts[1]);
+    int steps = std::stoi(parts[2]);
+    for(int i=0; i<steps; i++)
+    {
+        double ratio = steps == 1 ? 0 : static_cast<double>(i) / (steps - 1);
+        size_t capacity = static_cast<size_t>(std::llround(low * std::pow(high / low, ratio)));
+        if(capacities.empty() || capacities.back() != capacity)
+            capacities.push_back(capacity);
+    }
+    return capacities;
+}
+
+}   // namespace Bench
+}   // namespace Cache
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Cache
+{
+namespace Bench
+{
+
+// Belady最优替换(MIN)离线模拟 -> 命中率上界
+// 先一遍反向扫描求出每个请求的下次访问位置 再用大顶堆每次淘汰下次访问最远的key
+// 允许不缓存(bypass): 新key的下次访问比堆顶更远时直接不放入 对带准入的策略(如LRU-K)也是上界
+// key映射为稠密编号 每条请求占 4(编号) + 4(下次访问) 字节 1亿条请求约800MB
+class BeladySimulator
+{
+public:
+    struct Result
+    {
+        uint64_t requests = 0;
+        uint64_t hits = 0;
+
+        double hitRatio() const { return requests == 0 ? 0.0 : static_cast<double>(hits) / requests; }
+    };
+
+    // 追加一条请求 counted为false时只影响缓存内容不计入命中率(如写请求、预热阶段)
+    void add(uint64_t key, bool counted = true)
+    {
+        auto it = ids.find(key);
+        uint32_t id;
+        if(it == ids.end())
+        {
+            id = static_cast<uint32_t>(ids.size());
+            ids.emplace(key, id);
+        }
+        else
+            id = it->second;
+        sequence.push_back(id);
+        countedFlags.push_back(counted);
+    }
+
+    size_t size() const { return sequence.size(); }
+
+    // 反向扫描计算下次访问位置 必须在simulate之前调用 之后不再需要key映射
+    void finalize()
+    {
+        nextUse.assign(sequence.size(), Never);
+        std::vector<uint32_t> upcoming(ids.size(), Never);
+        for(size_t i = sequence.size(); i-- > 0; )
+        {
+            uint32_t id = sequence[i];
+            nextUse[i] = upcoming[id];
+            upcoming[id] = static_cast<uint32_t>(i);
+        }
+        distinctKeys = ids.size();
+        std::unordered_map<uint64_t, uint32_t>().swap(ids);
+    }
+
+    Result simulate(size_t capacity) const
+    {
+        Result result;
+        std::vector<uint32_t> cachedNext(distinctKeys, NotCached);
+        // (下次访问位置, 编号) 的大顶堆 惰性删除: 与cachedNext不一致的条目已过期
+        std::vector<std::pair<uint32_t, uint32_t>> heap;
+        heap.reserve(capacity * 2 + 16);
+        size_t cached = 0;
+
+        for(size_t i=0; i<sequence.size(); i++)
+        {
+            uint32_t id = sequence[i];
+            uint32_t next = nextUse[i];
+            bool counted = countedFlags[i];
+            if(counted)
+                result.requests++;
+
+            if(cachedNext[id] != NotCached)
+            {
+                // 命中: 更新下次访问位置 旧堆条目自然过期
+                if(counted)
+                    result.hits++;
+                cachedNext[id] = next;
+                pushHeap(heap, next, id);
+            }
+            else if(capacity > 0)
+            {
+                if(cached >= capacity)
+                {
+                    popStale(heap, cachedNext);
+                    // 新key比堆顶更晚被访问(或不再访问) -> 不放入
+                    if(next >= heap.front().first)
+                        continue;
+                    cachedNext[heap.front().second] = NotCached;
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                    cached--;
+                }
+                else if(next == Never)
+                    continue;
+                cachedNext[id] = next;
+                pushHeap(heap, next, id);
+                cached++;
+            }
+
+            // 过期条目过多时重建堆 保持堆大小为O(capacity)
+            if(heap.size() > capacity * 2 + 16)
+                rebuild(heap, cachedNext);
+        }
+        return result;
+    }
+
+private:
+    static constexpr uint32_t Never = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NotCached = std::numeric_limits<uint32_t>::max() - 1;
+
+    std::unordered_map<uint64_t, uint32_t> ids;     // key -> 稠密编号
+    std::vector<uint32_t> sequence;                 // 请求序列(编号)
+    std::vector<uint32_t> nextUse;                  // 每个请求的下次访问位置
+    std::vector<bool> countedFlags;
+    size_t distinctKeys = 0;
+
+    static void pushHeap(std::vector<std::pair<uint32_t, uint32_t>>& heap, uint32_t next, uint32_t id)
+    {
+        heap.emplace_back(next, id);
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    static bool isStale(const std::pair<uint32_t, uint32_t>& entry, const std::vector<uint32_t>& cachedNext)
+    {
+        return cachedNext[entry.second] != entry.first;
+    }
+
+    // 弹出堆顶的过期条目
+    static void popStale(std::vector<std::pair<uint32_t, uint32_t>>& heap, const std::vector<uint32_t>& cachedNext)
+    {
+        while(!heap.empty() && isStale(heap.front(), cachedNext))
+        {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+        }
+    }
+
+    static void rebuild(std::vector<std::pair<uint32_t, uint32_t>>& heap, const std::vector<uint32_t>& cachedNext)
+    {
+        heap.erase(std::remove_if(heap.begin(), heap.end(),
+                   [&cachedNext](const std::pair<uint32_t, uint32_t>& entry) { return isStale(entry, cachedNext); }),
+                   heap.end());
+        std::make_heap(heap.begin(), heap.end());
+    }
+};
+
+}   // namespace Bench
+}   // namespace Cache
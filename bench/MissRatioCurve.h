@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Cache
+{
+namespace Bench
+{
+
+// 树状数组(Fenwick) -> 前缀和与单点修改均为O(log n)
+class FenwickTree
+{
+public:
+    explicit FenwickTree(size_t size = 0) : tree(size + 1, 0) {}
+
+    size_t size() const { return tree.size() - 1; }
+
+    void add(size_t index, int delta)
+    {
+        for(size_t i = index + 1; i < tree.size(); i += i & (~i + 1))
+            tree[i] += delta;
+    }
+
+    // [0, index) 的和
+    int64_t prefixSum(size_t index) const
+    {
+        int64_t sum = 0;
+        for(size_t i = index; i > 0; i -= i & (~i + 1))
+            sum += tree[i];
+        return sum;
+    }
+
+private:
+    std::vector<int64_t> tree;
+};
+
+// 单遍LRU缺失率曲线: Mattson栈距离 + SHARDS空间采样
+// 栈距离 = 上次访问该key之后访问过的不同key数 容量大于栈距离的LRU缓存会命中
+// 用树状数组在"时间轴"上标记每个key最近一次访问的位置 区间和即为栈距离
+// 采样: 只处理 hash(key) mod P < T 的key(采样率R = T/P) 栈距离按1/R放大
+// 内存与时间都按采样率缩小 对同一个key总是同样取舍 保持其完整的重用序列
+class ShardsMRC
+{
+public:
+    static constexpr uint64_t Modulus = 1ull << 24;
+
+    explicit ShardsMRC(double samplingRate = 1.0)
+        : threshold(static_cast<uint64_t>(std::max(0.0, std::min(1.0, samplingRate)) * Modulus))
+        , rate(static_cast<double>(threshold) / Modulus)
+        , now(0)
+        , totalReferences(0)
+        , sampledReferences(0)
+        , coldMisses(0)
+        , tree(InitialTimeSlots)
+    {}
+
+    double samplingRate() const { return rate; }
+    uint64_t references() const { return totalReferences; }
+    uint64_t sampled() const { return sampledReferences; }
+    size_t trackedKeys() const { return lastAccess.size(); }
+
+    void access(uint64_t key)
+    {
+        totalReferences++;
+        if(threshold < Modulus && (mix(key) & (Modulus - 1)) >= threshold)
+            return;
+        sampledReferences++;
+
+        if(now >= tree.size())
+            compact();
+
+        auto it = lastAccess.find(key);
+        if(it == lastAccess.end())
+        {
+            coldMisses++;
+            lastAccess.emplace(key, now);
+        }
+        else
+        {
+            // (上次访问, 现在) 之间仍标记着的位置数 = 期间访问过的不同key数
+            uint64_t last = it->second;
+            uint64_t distance = static_cast<uint64_t>(tree.prefixSum(now) - tree.prefixSum(last + 1));
+            if(distance >= histogram.size())
+                histogram.resize(std::max<size_t>(distance + 1, histogram.size() * 2), 0);
+            histogram[distance]++;
+            tree.add(last, -1);
+            it->second = now;
+        }
+        tree.add(now, 1);
+        now++;
+    }
+
+    // 容量为capacity(对象数)的LRU缓存的缺失率估计
+    double missRatio(uint64_t capacity) const
+    {
+        std::vector<std::pair<uint64_t, double>> curve = missRatioCurve({capacity});
+        return curve.empty() ? 1.0 : curve.front().second;
+    }
+
+    // 一次计算多个容量 capacities需按升序给出
+    // SHARDS_adj修正: 实际采样数与期望采样数(总数 * R)之差计入距离为0的桶 抵消采样偏差
+    std::vector<std::pair<uint64_t, double>> missRatioCurve(const std::vector<uint64_t>& capacities) const
+    {
+        std::vector<std::pair<uint64_t, double>> curve;
+        if(sampledReferences == 0)
+            return curve;
+
+        double expected = totalReferences * rate;
+        double adjustment = expected - static_cast<double>(sampledReferences);
+        double total = std::max(expected, 1.0);
+
+        double hits = adjustment;
+        size_t distance = 0;
+        for(uint64_t capacity : capacities)
+        {
+            // 放大后的距离 d / R < capacity 即命中
+            double limit = capacity * rate;
+            while(distance < histogram.size() && distance < limit)
+                hits += histogram[distance++];
+            double ratio = 1.0 - hits / total;
+            curve.emplace_back(capacity, std::max(0.0, std::min(1.0, ratio)));
+        }
+        return curve;
+    }
+
+private:
+    static constexpr size_t InitialTimeSlots = 1 << 16;
+
+    uint64_t threshold;
+    double rate;
+    uint64_t now;                                       // 下一个采样访问的时间位置
+    uint64_t totalReferences;
+    uint64_t sampledReferences;
+    uint64_t coldMisses;
+    std::unordered_map<uint64_t, uint64_t> lastAccess;  // key -> 最近一次访问的时间位置
+    std::vector<uint64_t> histogram;                    // 采样后的栈距离直方图
+    FenwickTree tree;
+
+    static uint64_t mix(uint64_t key)
+    {
+        key += 0x9e3779b97f4a7c15ull;
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+        return key ^ (key >> 31);
+    }
+
+    // 时间轴用尽: 按最近访问的先后把所有key重新编号为0..m-1 并重建树状数组
+    void compact()
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> order;
+        order.reserve(lastAccess.size());
+        for(const auto& entry : lastAccess)
+            order.emplace_back(entry.second, entry.first);
+        std::sort(order.begin(), order.end());
+
+        size_t slots = std::max(InitialTimeSlots, order.size() * 2);
+        tree = FenwickTree(slots);
+        for(size_t i=0; i<order.size(); i++)
+        {
+            lastAccess[order[i].second] = i;
+            tree.add(i, 1);
+        }
+        now = order.size();
+    }
+};
+
+}   // namespace Bench
+}   // namespace Cache
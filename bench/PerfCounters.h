@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Cache
+{
+namespace Bench
+{
+
+// 硬件计数器(perf_event_open) -> 只统计用户态 每个事件单独打开
+// 内核不支持、虚拟机未透传或perf_event_paranoid禁止时对应事件不可用 其余照常计数
+class PerfCounters
+{
+public:
+    enum Event
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        EventCount
+    };
+
+    static const char* eventName(Event event)
+    {
+        static const char* names[EventCount] = {"cycles", "instructions", "cache-misses", "branch-misses"};
+        return names[event];
+    }
+
+    PerfCounters()
+    {
+        for(int i=0; i<EventCount; i++)
+        {
+            fds[i] = -1;
+            values[i] = 0;
+        }
+    }
+
+    ~PerfCounters() { close(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // 打开所有事件 返回是否至少有一个可用
+    bool open()
+    {
+        close();
+#if defined(__linux__)
+        static const uint64_t configs[EventCount] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for(int i=0; i<EventCount; i++)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+        return anyAvailable();
+    }
+
+    void close()
+    {
+        for(int i=0; i<EventCount; i++)
+        {
+#if defined(__linux__)
+            if(fds[i] >= 0)
+                ::close(fds[i]);
+#endif
+            fds[i] = -1;
+        }
+    }
+
+    bool available(Event event) const { return fds[event] >= 0; }
+
+    bool anyAvailable() const
+    {
+        for(int i=0; i<EventCount; i++)
+            if(fds[i] >= 0)
+                return true;
+        return false;
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        for(int i=0; i<EventCount; i++)
+            if(fds[i] >= 0)
+            {
+                ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    void stop()
+    {
+#if defined(__linux__)
+        for(int i=0; i<EventCount; i++)
+        {
+            values[i] = 0;
+            if(fds[i] < 0)
+                continue;
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t count = 0;
+            if(read(fds[i], &count, sizeof(count)) == sizeof(count))
+                values[i] = count;
+        }
+#endif
+    }
+
+    // 最近一次start/stop之间的计数
+    uint64_t value(Event event) const { return values[event]; }
+
+private:
+    int fds[EventCount];
+    uint64_t values[EventCount];
+};
+
+}   // namespace Bench
+}   // namespace Cache
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "LRU_CachePolicy.h"
+#include "LFU_CachePolicy.h"
+#include "CompactLRU_CachePolicy.h"
+#include "LRUKDistance_CachePolicy.h"
+#include "TwoQ_CachePolicy.h"
+#include "LIRS_CachePolicy.h"
+#include "ClockPro_CachePolicy.h"
+#include "SLRU_CachePolicy.h"
+#include "SegmentLRU_CachePolicy.h"
+#include "CompressedCache.h"
+#include "ThreadLocalCache.h"
+#include "SharedMemoryCache.h"
+
+namespace Cache
+{
+namespace Bench
+{
+
+// 所有可参与测试的策略名称
+inline const std::vector<std::string>& policyNames()
+{
+    static const std::vector<std::string> names = {"LRU", "LRU-Compact", "LRU-Segment", "LRU-LZ", "LRU-K", "LRU-2", "2Q", "LIRS", "CLOCK-Pro", "SLRU", "LRU-Hash", "LRU-Hash-L1", "LRU-Shm", "LFU", "LFU-Hash"};
+    return names;
+}
+
+// 按名称创建策略 -> historyCapacity为LRU-K的历史队列容量 未知名称或该key/value类型不支持时返回nullptr
+template<typename Key, typename Value>
+std::unique_ptr<Policy<Key, Value>> makePolicy(const std::string& name, size_t capacity, size_t historyCapacity)
+{
+    using PolicyPtr = std::unique_ptr<Policy<Key, Value>>;
+    int cap = static_cast<int>(capacity);
+    if(name == "LRU")
+        return PolicyPtr(new LRUCache<Key, Value>(cap));
+    if constexpr (IsCompactStorable<Key, Value>::value)
+    {
+        if(name == "LRU-Compact")
+            return PolicyPtr(new CompactLRUCache<Key, Value>(cap));
+    }
+    if constexpr (std::is_same<Value, std::string>::value)
+    {
+        // 内存预算按每条256字节估算 段大小取预算的1/16(4KB~1MB)
+        if(name == "LRU-Segment")
+        {
+            size_t budget = capacity * 256;
+            size_t segmentSize = std::min<size_t>(1 << 20, std::max<size_t>(4096, budget / 16));
+            return PolicyPtr(new SegmentLRUCache<Key, Value>(cap, budget, segmentSize));
+        }
+        // 不小于64字节的value压缩后存入LRU 不开启热层 每次命中都解压
+        if(name == "LRU-LZ")
+            return PolicyPtr(new CompressedCache<Key, Value>(PolicyPtr(new LRUCache<Key, Value>(cap)), 64));
+    }
+    if(name == "LRU-K")
+        return PolicyPtr(new LRU_KCache<Key, Value>(cap, static_cast<int>(historyCapacity), 2));
+    // 按后向2距离淘汰 非常驻访问历史的上限同LRU-K
+    if(name == "LRU-2")
+        return PolicyPtr(new LRUKDistanceCache<Key, Value, 2>(cap, static_cast<int>(historyCapacity)));
+    if(name == "2Q")
+        return PolicyPtr(new TwoQCache<Key, Value>(cap));
+    if(name == "LIRS")
+        return PolicyPtr(new LIRSCache<Key, Value>(cap));
+    if(name == "CLOCK-Pro")
+        return PolicyPtr(new ClockProCache<Key, Value>(cap));
+    if(name == "SLRU")
+        return PolicyPtr(new SLRUCache<Key, Value>(cap));
+    if(name == "LRU-Hash")
+        return PolicyPtr(new LRU_HashCache<Key, Value>(capacity));
+    // 每个线程256条的一级缓存 共享缓存为LRU-Hash
+    if(name == "LRU-Hash-L1")
+        return PolicyPtr(new ThreadLocalCache<Key, Value>(PolicyPtr(new LRU_HashCache<Key, Value>(capacity)), 256));
+    // 匿名共享内存映射 每条编码后至多256字节 16个分片
+    if(name == "LRU-Shm")
+        return PolicyPtr(new SharedMemoryCache<Key, Value>("", capacity, 256, 16));
+    if(name == "LFU")
+        return PolicyPtr(new LFUCache<Key, Value>(cap));
+    if(name == "LFU-Hash")
+        return PolicyPtr(new LFU_HashCache<Key, Value>(capacity, 0));
+    return nullptr;
+}
+
+}   // namespace Bench
+}   // namespace Cache
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Cache
+{
+namespace Bench
+{
+
+// 一条访问记录
+struct TraceRecord
+{
+    uint64_t key;
+    uint32_t size;      // 对象大小(字节) 未知时为0
+    bool isPut;         // 写请求 未标注时按读处理
+};
+
+// 只读内存映射文件 -> 由内核按需换入页面 不把整个文件读进内存
+class MappedFile
+{
+public:
+    MappedFile() : data(nullptr), length(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path)
+    {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            return false;
+        struct stat info;
+        if(fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        if(length > 0)
+        {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED)
+            {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            // 顺序读取 提示内核预读并及时回收已读页面
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if(data)
+            munmap(const_cast<char*>(data), length);
+#endif
+        data = nullptr;
+        length = 0;
+    }
+
+    const char* begin() const { return data; }
+    size_t size() const { return length; }
+
+private:
+    const char* data;
+    size_t length;
+};
+
+// 轨迹格式
+enum class TraceFormat
+{
+    Binary,         // 本项目的紧凑二进制格式 见 TraceReader::writeBinaryHeader
+    OracleGeneral,  // libCacheSim oracleGeneral: uint32 时间 + uint64 对象ID + uint32 大小 + int64 下次访问 共24字节
+    Csv             // 文本CSV 可配置key/大小/操作所在列
+};
+
+inline bool parseTraceFormat(const std::string& name, TraceFormat& format)
+{
+    if(name == "binary")
+        format = TraceFormat::Binary;
+    else if(name == "oracleGeneral")
+        format = TraceFormat::OracleGeneral;
+    else if(name == "csv")
+        format = TraceFormat::Csv;
+    else
+        return false;
+    return true;
+}
+
+// CSV列配置 列号从0开始 -1表示没有该列
+struct CsvOptions
+{
+    int keyColumn = 0;
+    int sizeColumn = -1;
+    int opColumn = -1;
+    bool hasHeader = false;
+    char delimiter = ',';
+};
+
+// 流式读取轨迹: 顺序遍历映射区域 每次产生一条记录
+class TraceReader
+{
+public:
+    // 二进制格式: 8字节魔数 + 每条12字节(uint64 key, uint32 最高位为写标记 低31位为大小)
+    static constexpr char BinaryMagic[9] = "CTRACE01";
+    static constexpr size_t BinaryRecordSize = 12;
+    static constexpr size_t OracleRecordSize = 24;
+
+    bool open(const std::string& path, TraceFormat format, const CsvOptions& csvOptions = CsvOptions())
+    {
+        this->format = format;
+        this->csvOptions = csvOptions;
+        if(!file.open(path))
+            return false;
+        if(format == TraceFormat::Binary)
+        {
+            if(file.size() < 8 || std::memcmp(file.begin(), BinaryMagic, 8) != 0)
+                return false;
+        }
+        reset();
+        return true;
+    }
+
+    // 回到第一条记录
+    void reset()
+    {
+        position = 0;
+        if(format == TraceFormat::Binary)
+            position = 8;
+        else if(format == TraceFormat::Csv && csvOptions.hasHeader)
+            skipLine();
+    }
+
+    bool next(TraceRecord& record)
+    {
+        switch(format)
+        {
+            case TraceFormat::Binary: return nextBinary(record);
+            case TraceFormat::OracleGeneral: return nextOracle(record);
+            case TraceFormat::Csv: return nextCsv(record);
+        }
+        return false;
+    }
+
+    static void writeBinaryHeader(std::ofstream& out)
+    {
+        out.write(BinaryMagic, 8);
+    }
+
+    static void writeBinaryRecord(std::ofstream& out, const TraceRecord& record)
+    {
+        char buffer[BinaryRecordSize];
+        uint32_t sizeAndOp = (record.size & 0x7fffffffu) | (record.isPut ? 0x80000000u : 0u);
+        std::memcpy(buffer, &record.key, 8);
+        std::memcpy(buffer + 8, &sizeAndOp, 4);
+        out.write(buffer, BinaryRecordSize);
+    }
+
+private:
+    MappedFile file;
+    TraceFormat format = TraceFormat::Binary;
+    CsvOptions csvOptions;
+    size_t position = 0;
+
+    bool nextBinary(TraceRecord& record)
+    {
+        if(position + BinaryRecordSize > file.size())
+            return false;
+        uint32_t sizeAndOp;
+        std::memcpy(&record.key, file.begin() + position, 8);
+        std::memcpy(&sizeAndOp, file.begin() + position + 8, 4);
+        record.size = sizeAndOp & 0x7fffffffu;
+        record.isPut = (sizeAndOp & 0x80000000u) != 0;
+        position += BinaryRecordSize;
+        return true;
+    }
+
+    bool nextOracle(TraceRecord& record)
+    {
+        if(position + OracleRecordSize > file.size())
+            return false;
+        std::memcpy(&record.key, file.begin() + position + 4, 8);
+        std::memcpy(&record.size, file.begin() + position + 12, 4);
+        record.isPut = false;
+        position += OracleRecordSize;
+        return true;
+    }
+
+    void skipLine()
+    {
+        const char* data = file.begin();
+        while(position < file.size() && data[position] != '\n')
+            position++;
+        if(position < file.size())
+            position++;
+    }
+
+    // 非数字的key按字符串哈希
+    static uint64_t parseKey(const char* begin, const char* end)
+    {
+        uint64_t value = 0;
+        bool numeric = begin < end;
+        for(const char* p = begin; p < end; p++)
+        {
+            if(*p < '0' || *p > '9')
+            {
+                numeric = false;
+                break;
+            }
+            value = value * 10 + (*p - '0');
+        }
+        if(numeric)
+            return value;
+        return std::hash<std::string>()(std::string(begin, end));
+    }
+
+    static bool isPutOp(const char* begin, const char* end)
+    {
+        std::string op(begin, end);
+        for(char& c : op)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return op == "set" || op == "put" || op == "write" || op == "add" || op == "replace" || op == "w";
+    }
+
+    bool nextCsv(TraceRecord& record)
+    {
+        const char* data = file.begin();
+        while(position < file.size())
+        {
+            size_t lineEnd = position;
+            while(lineEnd < file.size() && data[lineEnd] != '\n')
+                lineEnd++;
+            size_t lineBegin = position;
+            position = lineEnd < file.size() ? lineEnd + 1 : lineEnd;
+
+            // 跳过空行与注释行 去掉行尾\r
+            size_t end = lineEnd;
+            if(end > lineBegin && data[end - 1] == '\r')
+                end--;
+            if(end == lineBegin || data[lineBegin] == '#')
+                continue;
+
+            record.key = 0;
+            record.size = 0;
+            record.isPut = false;
+            bool hasKey = false;
+            int column = 0;
+            size_t fieldBegin = lineBegin;
+            for(size_t i = lineBegin; i <= end; i++)
+            {
+                if(i < end && data[i] != csvOptions.delimiter)
+                    continue;
+                const char* fieldStart = data + fieldBegin;
+                const char* fieldEnd = data + i;
+                if(column == csvOptions.keyColumn)
+                {
+                    record.key = parseKey(fieldStart, fieldEnd);
+                    hasKey = true;
+                }
+                else if(column == csvOptions.sizeColumn)
+                    record.size = static_cast<uint32_t>(std::strtoul(std::string(fieldStart, fieldEnd).c_str(), nullptr, 10));
+                else if(column == csvOptions.opColumn)
+                    record.isPut = isPutOp(fieldStart, fieldEnd);
+                column++;
+                fieldBegin = i + 1;
+            }
+            if(hasKey)
+                return true;
+        }
+        return false;
+    }
+};
+
+}   // namespace Bench
+}   // namespace Cache
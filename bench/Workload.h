@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Cache
+{
+namespace Bench
+{
+
+// 快速伪随机数发生器 xoshiro256** -> 固定种子即可完全复现
+class Random
+{
+public:
+    explicit Random(uint64_t seed)
+    {
+        // 用splitmix64把种子扩展成256位状态
+        for(auto& word : state)
+        {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next()
+    {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // [0, bound) 内的均匀整数(乘法取高位 避免取模)
+    uint64_t nextBounded(uint64_t bound)
+    {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+    // [0, 1) 内的均匀浮点数
+    double nextDouble()
+    {
+        return (next() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+// key生成器接口: 每次调用产生一个 [0, items) 内的key
+class KeyGenerator
+{
+public:
+    virtual ~KeyGenerator() {}
+    virtual uint64_t next(Random& rng) = 0;
+    virtual std::string name() const = 0;
+};
+
+// 均匀分布
+class UniformGenerator : public KeyGenerator
+{
+public:
+    explicit UniformGenerator(uint64_t items) : items(items) {}
+
+    uint64_t next(Random& rng) override { return rng.nextBounded(items); }
+    std::string name() const override { return "uniform"; }
+
+private:
+    uint64_t items;
+};
+
+// 顺序循环扫描 0, 1, ..., items-1, 0, ...
+class SequentialGenerator : public KeyGenerator
+{
+public:
+    explicit SequentialGenerator(uint64_t items) : items(items), current(0) {}
+
+    uint64_t next(Random&) override
+    {
+        uint64_t key = current;
+        current = (current + 1) % items;
+        return key;
+    }
+    std::string name() const override { return "sequential"; }
+
+private:
+    uint64_t items;
+    uint64_t current;
+};
+
+// zeta(n, theta) = sum_{i=1..n} 1 / i^theta
+// 计算为O(n) -> 按(n, theta)缓存结果 同一进程内多个生成器(如每线程一个)只计算一次
+inline double zeta(uint64_t n, double theta)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<uint64_t, double>, double> computed;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_pair(n, theta);
+    auto it = computed.find(key);
+    if(it != computed.end())
+        return it->second;
+
+    // 从已缓存的最大的更小n处增量计算
+    double sum = 0;
+    uint64_t from = 0;
+    for(auto& entry : computed)
+    {
+        if(entry.first.second == theta && entry.first.first < n && entry.first.first > from)
+        {
+            from = entry.first.first;
+            sum = entry.second;
+        }
+    }
+    for(uint64_t i = from + 1; i <= n; i++)
+        sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    computed[key] = sum;
+    return sum;
+}
+
+// YCSB风格Zipf分布(Gray等人的快速算法): key 0 最热 热度按排名的 theta 次幂衰减
+// theta取值(0, 1) 越大越倾斜 YCSB默认0.99
+class ZipfianGenerator : public KeyGenerator
+{
+public:
+    ZipfianGenerator(uint64_t items, double theta = 0.99)
+        : items(items)
+        , theta(theta)
+        , zetan(zeta(items, theta))
+    {
+        double zeta2 = zeta(2, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1 - std::pow(2.0 / items, 1 - theta)) / (1 - zeta2 / zetan);
+        halfPowTheta = 1.0 + std::pow(0.5, theta);
+    }
+
+    uint64_t next(Random& rng) override
+    {
+        double u = rng.nextDouble();
+        double uz = u * zetan;
+        if(uz < 1.0)
+            return 0;
+        if(uz < halfPowTheta)
+            return items > 1 ? 1 : 0;
+        uint64_t key = static_cast<uint64_t>(items * std::pow(eta * u - eta + 1, alpha));
+        return key < items ? key : items - 1;
+    }
+    std::string name() const override { return "zipfian"; }
+
+private:
+    uint64_t items;
+    double theta;
+    double zetan;
+    double alpha;
+    double eta;
+    double halfPowTheta;
+};
+
+// 打散的Zipf分布: 热度分布与Zipf相同 但热点key经哈希散布到整个key空间
+// 避免热点全部集中在小编号key上(对按key取模分片的缓存更接近真实)
+class ScrambledZipfianGenerator : public KeyGenerator
+{
+public:
+    ScrambledZipfianGenerator(uint64_t items, double theta = 0.99)
+        : items(items)
+        , zipfian(items, theta)
+    {}
+
+    uint64_t next(Random& rng) override
+    {
+        return fnvHash64(zipfian.next(rng)) % items;
+    }
+    std::string name() const override { return "scrambled-zipfian"; }
+
+private:
+    uint64_t items;
+    ZipfianGenerator zipfian;
+
+    // FNV-1a 64位
+    static uint64_t fnvHash64(uint64_t value)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for(int i=0; i<8; i++)
+        {
+            hash ^= value & 0xff;
+            hash *= 0x100000001b3ull;
+            value >>= 8;
+        }
+        return hash;
+    }
+};
+
+// 热点分布: hotOpnFraction的操作均匀落在前hotSetFraction的key上 其余均匀落在剩余key上
+class HotspotGenerator : public KeyGenerator
+{
+public:
+    HotspotGenerator(uint64_t items, double hotSetFraction = 0.2, double hotOpnFraction = 0.8)
+        : items(items)
+        , hotOpnFraction(hotOpnFraction)
+    {
+        hotSetSize = static_cast<uint64_t>(items * hotSetFraction);
+        hotSetSize = std::max<uint64_t>(1, std::min(hotSetSize, items));
+    }
+
+    uint64_t next(Random& rng) override
+    {
+        if(hotSetSize == items || rng.nextDouble() < hotOpnFraction)
+            return rng.nextBounded(hotSetSize);
+        return hotSetSize + rng.nextBounded(items - hotSetSize);
+    }
+    std::string name() const override { return "hotspot"; }
+
+private:
+    uint64_t items;
+    uint64_t hotSetSize;
+    double hotOpnFraction;
+};
+
+// 最近写入优先: 维护一个不断前进的"最新key" 访问离最新key越近的key概率越高(Zipf)
+// 每次调用以insertFraction的概率前进一步 模拟新数据不断写入
+class LatestGenerator : public KeyGenerator
+{
+public:
+    LatestGenerator(uint64_t items, double theta = 0.99, double insertFraction = 0.05)
+        : items(items)
+        , insertFraction(insertFraction)
+        , latest(0)
+        , zipfian(items, theta)
+    {}
+
+    uint64_t next(Random& rng) override
+    {
+        if(rng.nextDouble() < insertFraction)
+            latest = (latest + 1) % items;
+        uint64_t distance = zipfian.next(rng);
+        return (latest + items - distance) % items;
+    }
+    std::string name() const override { return "latest"; }
+
+private:
+    uint64_t items;
+    double insertFraction;
+    uint64_t latest;
+    ZipfianGenerator zipfian;
+};
+
+// 指数分布(YCSB ExponentialGenerator): percentile%的访问落在前 fraction*items 个key上
+class ExponentialGenerator : public KeyGenerator
+{
+public:
+    ExponentialGenerator(uint64_t items, double percentile = 95, double fraction = 0.8571428571)
+        : items(items)
+    {
+        gamma = -std::log(1.0 - percentile / 100.0) / (items * fraction);
+    }
+
+    uint64_t next(Random& rng) override
+    {
+        // 超出key空间的部分折回
+        double u = 1.0 - rng.nextDouble();
+        return static_cast<uint64_t>(-std::log(u) / gamma) % items;
+    }
+    std::string name() const override { return "exponential"; }
+
+private:
+    uint64_t items;
+    double gamma;
+};
+
+// 生成器参数
+struct GeneratorOptions
+{
+    double theta = 0.99;                    // zipfian/scrambled-zipfian/latest 的倾斜度
+    double hotSetFraction = 0.2;            // hotspot 热点key比例
+    double hotOpnFraction = 0.8;            // hotspot 访问热点的操作比例
+    double latestInsertFraction = 0.05;     // latest 最新key前进的概率
+    double exponentialPercentile = 95;      // exponential 落在前fraction的访问百分比
+    double exponentialFraction = 0.8571428571;
+};
+
+// 按名称创建生成器 未知名称返回nullptr
+inline std::unique_ptr<KeyGenerator> makeGenerator(const std::string& name, uint64_t items,
+                                                   const GeneratorOptions& options = GeneratorOptions())
+{
+    if(name == "uniform")
+        return std::unique_ptr<KeyGenerator>(new UniformGenerator(items));
+    if(name == "sequential")
+        return std::unique_ptr<KeyGenerator>(new SequentialGenerator(items));
+    if(name == "zipfian")
+        return std::unique_ptr<KeyGenerator>(new ZipfianGenerator(items, options.theta));
+    if(name == "scrambled-zipfian")
+        return std::unique_ptr<KeyGenerator>(new ScrambledZipfianGenerator(items, options.theta));
+    if(name == "hotspot")
+        return std::unique_ptr<KeyGenerator>(
+            new HotspotGenerator(items, options.hotSetFraction, options.hotOpnFraction));
+    if(name == "latest")
+        return std::unique_ptr<KeyGenerator>(
+            new LatestGenerator(items, options.theta, options.latestInsertFraction));
+    if(name == "exponential")
+        return std::unique_ptr<KeyGenerator>(
+            new ExponentialGenerator(items, options.exponentialPercentile, options.exponentialFraction));
+    return nullptr;
+}
+
+// 一次缓存操作: key + 读/写 + 写入值的变体编号(由调用方解释 不影响key序列)
+struct Operation
+{
+    uint32_t key;
+    bool isPut;
+    uint8_t tag = 0;
+};
+
+// 预先生成操作序列 -> 生成开销不计入计时区间
+inline std::vector<Operation> generateOperations(KeyGenerator& generator, Random& rng,
+                                                 size_t count, double readRatio)
+{
+    std::vector<Operation> operations;
+    operations.reserve(count);
+    for(size_t i=0; i<count; i++)
+    {
+        Operation op;
+        op.isPut = rng.nextDouble() >= readRatio;
+        op.key = static_cast<uint32_t>(generator.next(rng));
+        operations.push_back(op);
+    }
+    return operations;
+}
+
+}   // namespace Bench
+}   // namespace Cache
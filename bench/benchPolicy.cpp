@@ -0,0 +1,357 @@
+// 多线程吞吐基准: 扫描 线程数 x 读写比例 x key分布 x 容量 x 策略
+// 输出吞吐、get/put延迟分位数与命中率 可另存为CSV/JSON便于跨版本对比
+//
+// 用法: CacheBench [--policies LRU,LFU] [--threads 1,2,4] [--read-ratios 0.5,0.9]
+//                  [--dists uniform,sequential,zipfian,scrambled-zipfian,hotspot,latest,exponential]
+//                  [--theta 0.99] [--capacities 1000,100000]
+//                  [--keys 1000000] [--ops 1000000] [--value-size 16]
+//                  [--seed 42] [--sample-shift 0] [--opt 1] [--csv out.csv] [--json out.json]
+//
+// 单线程配置下额外输出OPT(Belady最优替换)在同一操作序列上的命中率 作为上界
+
+#include "ArgParse.h"
+#include "Belady.h"
+#include "PolicyFactory.h"
+#include "Workload.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Cache;
+using namespace Cache::Bench;
+using std::string, std::cout;
+
+struct BenchConfig
+{
+    std::vector<string> policies = policyNames();
+    std::vector<int> threads;
+    std::vector<double> readRatios = {0.5, 0.9, 0.99};
+    std::vector<string> dists = {"uniform", "sequential", "scrambled-zipfian", "hotspot"};
+    GeneratorOptions generatorOptions;  // 分布参数(theta等)
+    std::vector<size_t> capacities = {1000, 100000};
+    size_t keys = 1000000;              // key空间大小
+    size_t opsPerThread = 1000000;      // 每个线程的操作数
+    size_t valueSize = 16;              // value字节数
+    uint64_t seed = 42;                 // 基础种子 各线程在此基础上派生
+    unsigned sampleShift = 0;           // 延迟采样 每2^n次记录一次
+    bool optimal = true;                // 单线程时输出OPT命中率
+    string csvPath;
+    string jsonPath;
+};
+
+struct BenchResult
+{
+    string policy;
+    string dist;
+    int threads;
+    double readRatio;
+    size_t capacity;
+    size_t keys;
+    uint64_t ops;
+    double seconds;
+    double opsPerSecond;
+    double hitRatio;
+    HistogramSnapshot getLatency;
+    HistogramSnapshot putLatency;
+};
+
+// 默认线程数: 1, 2, 4, ... 直到CPU核心数
+static std::vector<int> defaultThreads()
+{
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threads;
+    for(int n = 1; n < cores; n *= 2)
+        threads.push_back(n);
+    threads.push_back(cores);
+    return threads;
+}
+
+static bool parseArgs(int argc, char** argv, BenchConfig& config)
+{
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cerr << "参数缺少取值: " << arg << "\n";
+            return false;
+        }
+        string value = argv[++i];
+        if(arg == "--policies")
+            config.policies = parseList<string>(value);
+        else if(arg == "--threads")
+            config.threads = parseList<int>(value);
+        else if(arg == "--read-ratios")
+            config.readRatios = parseList<double>(value);
+        else if(arg == "--dists")
+            config.dists = parseList<string>(value);
+        else if(arg == "--theta")
+        {
+            // Zipf的alpha = 1 / (1 - theta) theta须在(0, 1)内
+            config.generatorOptions.theta = std::stod(value);
+            if(!(config.generatorOptions.theta > 0 && config.generatorOptions.theta < 1))
+            {
+                std::cerr << "--theta 须在(0, 1)内: " << value << "\n";
+                return false;
+            }
+        }
+        else if(arg == "--capacities")
+            config.capacities = parseList<size_t>(value);
+        else if(arg == "--keys")
+            config.keys = std::stoull(value);
+        else if(arg == "--ops")
+            config.opsPerThread = std::stoull(value);
+        else if(arg == "--value-size")
+            config.valueSize = std::stoull(value);
+        else if(arg == "--seed")
+            config.seed = std::stoull(value);
+        else if(arg == "--sample-shift")
+            config.sampleShift = std::stoul(value);
+        else if(arg == "--opt")
+            config.optimal = value != "0";
+        else if(arg == "--csv")
+            config.csvPath = value;
+        else if(arg == "--json")
+            config.jsonPath = value;
+        else
+        {
+            std::cerr << "未知参数: " << arg << "\n";
+            return false;
+        }
+    }
+    if(config.threads.empty())
+        config.threads = defaultThreads();
+    return true;
+}
+
+// 执行一组操作: 读未命中时回填(cache-aside) 写直接放入
+static void runOperations(Policy<int, string>& cache, const std::vector<Operation>& operations, const string& value)
+{
+    string result;
+    for(const Operation& op : operations)
+    {
+        int key = static_cast<int>(op.key);
+        if(op.isPut)
+            cache.put(key, value);
+        else if(!cache.get(key, result))
+            cache.put(key, value);
+    }
+}
+
+// 预热与计时阶段的操作序列 与runOne中单线程时完全一致
+static std::vector<Operation> warmupOperations(const BenchConfig& config, const string& dist,
+                                               double readRatio, size_t capacity)
+{
+    auto generator = makeGenerator(dist, config.keys, config.generatorOptions);
+    Random rng(config.seed * 1000003 + 999983);
+    return generateOperations(*generator, rng, capacity * 2, readRatio);
+}
+
+static bool runOne(const BenchConfig& config, const string& policyName, const string& dist,
+                   int threadNum, double readRatio, size_t capacity, BenchResult& result)
+{
+    // LRU-K的历史记录暂存value 取与容量相同 使其内存与其他策略可比(OPT按同一容量计算)
+    auto cache = makePolicy<int, string>(policyName, capacity, capacity);
+    if(!cache)
+    {
+        std::cerr << "未知策略: " << policyName << "\n";
+        return false;
+    }
+
+    // 各线程的操作序列由固定种子派生 在计时前生成完毕
+    std::vector<std::vector<Operation>> threadOperations(threadNum);
+    for(int t=0; t<threadNum; t++)
+    {
+        auto generator = makeGenerator(dist, config.keys, config.generatorOptions);
+        if(!generator)
+        {
+            std::cerr << "未知分布: " << dist << "\n";
+            return false;
+        }
+        Random rng(config.seed * 1000003 + t);
+        threadOperations[t] = generateOperations(*generator, rng, config.opsPerThread, readRatio);
+    }
+
+    string value(config.valueSize, 'v');
+
+    // 预热: 单线程先跑一遍容量两倍的操作 让缓存进入稳态
+    runOperations(*cache, warmupOperations(config, dist, readRatio, capacity), value);
+
+    cache->enableLatency(config.sampleShift);
+    CacheStats before = cache->stats();
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> start{false};
+    std::vector<std::thread> workers;
+    for(int t=0; t<threadNum; t++)
+    {
+        workers.emplace_back([&, t]()
+        {
+            ready.fetch_add(1);
+            while(!start.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            runOperations(*cache, threadOperations[t], value);
+        });
+    }
+    while(ready.load() < threadNum)
+        std::this_thread::yield();
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for(auto& worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    CacheStats after = cache->stats();
+    uint64_t hits = after.hits - before.hits;
+    uint64_t lookups = hits + after.misses - before.misses;
+
+    result.policy = policyName;
+    result.dist = dist;
+    result.threads = threadNum;
+    result.readRatio = readRatio;
+    result.capacity = capacity;
+    result.keys = config.keys;
+    result.ops = static_cast<uint64_t>(threadNum) * config.opsPerThread;
+    result.seconds = seconds;
+    result.opsPerSecond = seconds > 0 ? result.ops / seconds : 0;
+    result.hitRatio = lookups == 0 ? 0 : static_cast<double>(hits) / lookups;
+    result.getLatency = cache->latency(LatencyRecorder::Get);
+    result.putLatency = cache->latency(LatencyRecorder::Put);
+    return true;
+}
+
+// OPT: 在单线程的预热 + 计时序列上离线模拟 只统计计时阶段的读
+static void runOptimal(const BenchConfig& config, const string& dist, double readRatio,
+                       size_t capacity, BenchResult& result)
+{
+    BeladySimulator belady;
+    for(const Operation& op : warmupOperations(config, dist, readRatio, capacity))
+        belady.add(op.key, false);
+
+    auto generator = makeGenerator(dist, config.keys, config.generatorOptions);
+    Random rng(config.seed * 1000003);
+    for(const Operation& op : generateOperations(*generator, rng, config.opsPerThread, readRatio))
+        belady.add(op.key, !op.isPut);
+    belady.finalize();
+    BeladySimulator::Result optimal = belady.simulate(capacity);
+
+    result = BenchResult();
+    result.policy = "OPT";
+    result.dist = dist;
+    result.threads = 1;
+    result.readRatio = readRatio;
+    result.capacity = capacity;
+    result.keys = config.keys;
+    result.ops = config.opsPerThread;
+    result.seconds = 0;
+    result.opsPerSecond = 0;
+    result.hitRatio = optimal.hitRatio();
+}
+
+static void printHeader()
+{
+    cout << std::left << std::setw(13) << "policy" << std::setw(19) << "dist"
+         << std::right << std::setw(8) << "threads" << std::setw(7) << "read"
+         << std::setw(10) << "capacity" << std::setw(14) << "ops/s"
+         << std::setw(9) << "hit%" << std::setw(10) << "get p50" << std::setw(10) << "get p99"
+         << std::setw(11) << "get p99.9" << std::setw(10) << "put p99" << "\n";
+}
+
+static void printResult(const BenchResult& r)
+{
+    cout << std::left << std::setw(13) << r.policy << std::setw(19) << r.dist
+         << std::right << std::setw(8) << r.threads << std::setw(7) << std::fixed << std::setprecision(2) << r.readRatio
+         << std::setw(10) << r.capacity << std::setw(14) << std::setprecision(0) << r.opsPerSecond
+         << std::setw(9) << std::setprecision(2) << r.hitRatio * 100
+         << std::setw(10) << r.getLatency.percentile(50) << std::setw(10) << r.getLatency.percentile(99)
+         << std::setw(11) << r.getLatency.percentile(99.9) << std::setw(10) << r.putLatency.percentile(99) << std::endl;
+}
+
+static void writeCsv(const string& path, const std::vector<BenchResult>& results)
+{
+    std::ofstream out(path);
+    out << "policy,dist,threads,read_ratio,capacity,keys,ops,seconds,ops_per_sec,hit_ratio,"
+           "get_p50_ns,get_p99_ns,get_p999_ns,get_max_ns,put_p50_ns,put_p99_ns,put_p999_ns,put_max_ns\n";
+    for(const BenchResult& r : results)
+    {
+        out << r.policy << ',' << r.dist << ',' << r.threads << ',' << r.readRatio << ','
+            << r.capacity << ',' << r.keys << ',' << r.ops << ',' << r.seconds << ','
+            << r.opsPerSecond << ',' << r.hitRatio << ','
+            << r.getLatency.percentile(50) << ',' << r.getLatency.percentile(99) << ','
+            << r.getLatency.percentile(99.9) << ',' << r.getLatency.max << ','
+            << r.putLatency.percentile(50) << ',' << r.putLatency.percentile(99) << ','
+            << r.putLatency.percentile(99.9) << ',' << r.putLatency.max << '\n';
+    }
+}
+
+static void writeLatencyJson(std::ofstream& out, const HistogramSnapshot& latency)
+{
+    out << "{\"count\": " << latency.count << ", \"p50\": " << latency.percentile(50)
+        << ", \"p99\": " << latency.percentile(99) << ", \"p999\": " << latency.percentile(99.9)
+        << ", \"max\": " << latency.max << "}";
+}
+
+static void writeJson(const string& path, const std::vector<BenchResult>& results)
+{
+    std::ofstream out(path);
+    out << "[\n";
+    for(size_t i=0; i<results.size(); i++)
+    {
+        const BenchResult& r = results[i];
+        out << "  {\"policy\": \"" << r.policy << "\", \"dist\": \"" << r.dist << "\", \"threads\": " << r.threads
+            << ", \"read_ratio\": " << r.readRatio << ", \"capacity\": " << r.capacity << ", \"keys\": " << r.keys
+            << ", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds << ", \"ops_per_sec\": " << r.opsPerSecond
+            << ", \"hit_ratio\": " << r.hitRatio << ", \"get_ns\": ";
+        writeLatencyJson(out, r.getLatency);
+        out << ", \"put_ns\": ";
+        writeLatencyJson(out, r.putLatency);
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    if(!parseArgs(argc, argv, config))
+        return 1;
+
+    std::vector<BenchResult> results;
+    printHeader();
+    for(const string& dist : config.dists)
+        for(size_t capacity : config.capacities)
+            for(double readRatio : config.readRatios)
+                for(int threadNum : config.threads)
+                {
+                    for(const string& policy : config.policies)
+                    {
+                        BenchResult result;
+                        if(!runOne(config, policy, dist, threadNum, readRatio, capacity, result))
+                            return 1;
+                        printResult(result);
+                        results.push_back(result);
+                    }
+                    if(config.optimal && threadNum == 1)
+                    {
+                        BenchResult result;
+                        runOptimal(config, dist, readRatio, capacity, result);
+                        printResult(result);
+                        results.push_back(result);
+                    }
+                }
+
+    if(!config.csvPath.empty())
+        writeCsv(config.csvPath, results);
+    if(!config.jsonPath.empty())
+        writeJson(config.jsonPath, results);
+    return 0;
+}
@@ -0,0 +1,424 @@
+// 微基准: 分别测量单个热路径的开销 便于单独评估每一项优化
+//
+// 用法: MicroBench [--cases lru-hit,lru-evict,lfu-hit,lruk-history,lruhash-hit]
+//                  [--key-types int,string] [--capacities 16,256,4096,65536,1048576,16777216]
+//                  [--capacity-range 16:16777216:7] [--min-time 0.2] [--slices 8]
+//                  [--seed 42] [--counters 1] [--csv out.csv]
+//
+// lru-hit       LRUCache::get命中 -> 查表 + moveToMostRecent
+// lru-evict     LRUCache::put新key且已满 -> addNewNode + removeLeastRecent
+// lfu-hit       LFUCache::get命中 -> getInternel 频次链表间移动
+// lruk-history  LRU_KCache::get未进入主缓存的key -> 历史记录计数更新
+// lruhash-hit   LRU_HashCache::get命中 -> 哈希分片分发 + 分片内命中(与lru-hit之差即分发开销)
+//
+// 每项先按容量填满缓存 再倍增迭代次数直到单批耗时不少于min-time(与google-benchmark相同)
+// 访问顺序在计时前生成 可用时附带每次操作的硬件计数(perf_event_open)
+// 16M容量的string用例约需4GB内存
+
+#include "ArgParse.h"
+#include "PerfCounters.h"
+#include "Workload.h"
+
+#include "CachePolicy.h"
+#include "LRU_CachePolicy.h"
+#include "LFU_CachePolicy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Cache;
+using namespace Cache::Bench;
+using std::string, std::cout;
+
+struct MicroConfig
+{
+    std::vector<string> cases = {"lru-hit", "lru-evict", "lfu-hit", "lruk-history", "lruhash-hit"};
+    std::vector<string> keyTypes = {"int", "string"};
+    std::vector<size_t> capacities = {16, 256, 4096, 65536, 1 << 20, 1 << 24};
+    double minTime = 0.2;       // 单批最短耗时(秒)
+    int slices = 8;             // lruhash-hit的分片数
+    uint64_t seed = 42;
+    bool counters = true;
+    string csvPath;
+};
+
+struct MicroResult
+{
+    string name;
+    string keyType;
+    size_t capacity;
+    uint64_t iterations;
+    double nsPerOp;
+    bool hasCounter[PerfCounters::EventCount];
+    double counterPerOp[PerfCounters::EventCount];
+};
+
+// 阻止编译器把结果未被使用的操作优化掉
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// 各key类型的样本数据: string的key与value都在短字符串优化(SSO)范围内 不额外分配
+template<typename T>
+struct Sample;
+
+template<>
+struct Sample<int>
+{
+    static const char* name() { return "int"; }
+    static int key(size_t i) { return static_cast<int>(i); }
+    static int value(size_t i) { return static_cast<int>(i * 2654435761u); }
+};
+
+template<>
+struct Sample<string>
+{
+    static const char* name() { return "string"; }
+    static string key(size_t i) { return "key:" + std::to_string(i); }
+    static string value(size_t i) { return "val:" + std::to_string(i); }
+};
+
+template<typename T>
+static std::vector<T> makeKeys(size_t count)
+{
+    std::vector<T> keys;
+    keys.reserve(count);
+    for(size_t i=0; i<count; i++)
+        keys.push_back(Sample<T>::key(i));
+    return keys;
+}
+
+template<typename T>
+static std::vector<T> makeValues(size_t count)
+{
+    std::vector<T> values;
+    values.reserve(count);
+    for(size_t i=0; i<count; i++)
+        values.push_back(Sample<T>::value(i));
+    return values;
+}
+
+// [0, range)内的随机访问顺序 至少64K项 避免小容量时顺序过短而被分支预测器记住
+static std::vector<uint32_t> randomOrder(size_t range, uint64_t seed)
+{
+    Random rng(seed);
+    std::vector<uint32_t> order(std::max<size_t>(range, 1 << 16));
+    for(uint32_t& index : order)
+        index = static_cast<uint32_t>(rng.nextBounded(range));
+    return order;
+}
+
+// 倍增迭代次数直到单批耗时不少于minTime 返回最后一批的结果
+// body(n)执行n次被测操作 状态在批之间延续(缓存保持稳态)
+template<typename Body>
+static MicroResult measure(const MicroConfig& config, PerfCounters& counters, Body&& body)
+{
+    MicroResult result{};
+    uint64_t iterations = 1024;
+    while(true)
+    {
+        counters.start();
+        auto begin = std::chrono::steady_clock::now();
+        body(iterations);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        counters.stop();
+
+        if(seconds >= config.minTime || iterations >= (1ull << 36))
+        {
+            result.iterations = iterations;
+            result.nsPerOp = seconds * 1e9 / iterations;
+            for(int i=0; i<PerfCounters::EventCount; i++)
+            {
+                auto event = static_cast<PerfCounters::Event>(i);
+                result.hasCounter[i] = counters.available(event);
+                result.counterPerOp[i] = static_cast<double>(counters.value(event)) / iterations;
+            }
+            return result;
+        }
+        // 按本批速度估算达到minTime所需的次数 单次最多放大10倍
+        double multiplier = seconds <= 0 ? 10.0 : std::min(10.0, config.minTime * 1.4 / seconds);
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * multiplier));
+    }
+}
+
+template<typename T>
+static MicroResult benchLruHit(const MicroConfig& config, PerfCounters& counters, size_t capacity)
+{
+    std::vector<T> keys = makeKeys<T>(capacity);
+    std::vector<T> values = makeValues<T>(capacity);
+    std::vector<uint32_t> order = randomOrder(capacity, config.seed);
+
+    LRUCache<T, T> cache(static_cast<int>(capacity));
+    for(size_t i=0; i<capacity; i++)
+        cache.put(keys[i], values[i]);
+
+    size_t position = 0;
+    T value{};
+    return measure(config, counters, [&](uint64_t iterations)
+    {
+        for(uint64_t n=0; n<iterations; n++)
+        {
+            cache.get(keys[order[position]], value);
+            if(++position == order.size())
+                position = 0;
+        }
+        doNotOptimize(value);
+    });
+}
+
+template<typename T>
+static MicroResult benchLruEvict(const MicroConfig& config, PerfCounters& counters, size_t capacity)
+{
+    // 循环放入2倍容量的key: 每次放入的key都是最早被驱逐的那个 -> 每次都未命中并驱逐
+    std::vector<T> keys = makeKeys<T>(capacity * 2);
+    std::vector<T> values = makeValues<T>(capacity * 2);
+
+    LRUCache<T, T> cache(static_cast<int>(capacity));
+    for(size_t i=0; i<capacity; i++)
+        cache.put(keys[i], values[i]);
+
+    size_t position = capacity;
+    return measure(config, counters, [&](uint64_t iterations)
+    {
+        for(uint64_t n=0; n<iterations; n++)
+        {
+            cache.put(keys[position], values[position]);
+            if(++position == keys.size())
+                position = 0;
+        }
+    });
+}
+
+template<typename T>
+static MicroResult benchLfuHit(const MicroConfig& config, PerfCounters& counters, size_t capacity)
+{
+    std::vector<T> keys = makeKeys<T>(capacity);
+    std::vector<T> values = makeValues<T>(capacity);
+    std::vector<uint32_t> order = randomOrder(capacity, config.seed);
+
+    LFUCache<T, T> cache(static_cast<int>(capacity));
+    for(size_t i=0; i<capacity; i++)
+        cache.put(keys[i], values[i]);
+
+    size_t position = 0;
+    T value{};
+    return measure(config, counters, [&](uint64_t iterations)
+    {
+        for(uint64_t n=0; n<iterations; n++)
+        {
+            cache.get(keys[order[position]], value);
+            if(++position == order.size())
+                position = 0;
+        }
+        doNotOptimize(value);
+    });
+}
+
+template<typename T>
+static MicroResult benchLruKHistory(const MicroConfig& config, PerfCounters& counters, size_t capacity)
+{
+    // K取最大值: key永远不进入主缓存 每次get都只更新历史记录中的计数
+    std::vector<T> keys = makeKeys<T>(capacity);
+    std::vector<uint32_t> order = randomOrder(capacity, config.seed);
+
+    LRU_KCache<T, T> cache(static_cast<int>(capacity), static_cast<int>(capacity), INT_MAX);
+    for(size_t i=0; i<capacity; i++)
+        cache.get(keys[i]);
+
+    size_t position = 0;
+    return measure(config, counters, [&](uint64_t iterations)
+    {
+        for(uint64_t n=0; n<iterations; n++)
+        {
+            T value = cache.get(keys[order[position]]);
+            doNotOptimize(value);
+            if(++position == order.size())
+                position = 0;
+        }
+    });
+}
+
+template<typename T>
+static MicroResult benchLruHashHit(const MicroConfig& config, PerfCounters& counters, size_t capacity)
+{
+    std::vector<T> keys = makeKeys<T>(capacity);
+    std::vector<T> values = makeValues<T>(capacity);
+    std::vector<uint32_t> order = randomOrder(capacity, config.seed);
+
+    // 分片容量按哈希分布略有差异 总容量放大一倍保证所有key都能留在缓存中
+    LRU_HashCache<T, T> cache(capacity * 2, config.slices);
+    for(size_t i=0; i<capacity; i++)
+        cache.put(keys[i], values[i]);
+
+    size_t position = 0;
+    T value{};
+    return measure(config, counters, [&](uint64_t iterations)
+    {
+        for(uint64_t n=0; n<iterations; n++)
+        {
+            cache.get(keys[order[position]], value);
+            if(++position == order.size())
+                position = 0;
+        }
+        doNotOptimize(value);
+    });
+}
+
+template<typename T>
+static bool runCase(const MicroConfig& config, PerfCounters& counters, const string& name,
+                    size_t capacity, MicroResult& result)
+{
+    if(name == "lru-hit")
+        result = benchLruHit<T>(config, counters, capacity);
+    else if(name == "lru-evict")
+        result = benchLruEvict<T>(config, counters, capacity);
+    else if(name == "lfu-hit")
+        result = benchLfuHit<T>(config, counters, capacity);
+    else if(name == "lruk-history")
+        result = benchLruKHistory<T>(config, counters, capacity);
+    else if(name == "lruhash-hit")
+        result = benchLruHashHit<T>(config, counters, capacity);
+    else
+        return false;
+    result.name = name;
+    result.keyType = Sample<T>::name();
+    result.capacity = capacity;
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv, MicroConfig& config)
+{
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cerr << "参数缺少取值: " << arg << "\n";
+            return false;
+        }
+        string value = argv[++i];
+        if(arg == "--cases")
+            config.cases = parseList<string>(value);
+        else if(arg == "--key-types")
+            config.keyTypes = parseList<string>(value);
+        else if(arg == "--capacities")
+            config.capacities = parseList<size_t>(value);
+        else if(arg == "--capacity-range")
+            config.capacities = parseCapacityRange(value);
+        else if(arg == "--min-time")
+            config.minTime = std::stod(value);
+        else if(arg == "--slices")
+            config.slices = std::max(1, std::stoi(value));
+        else if(arg == "--seed")
+            config.seed = std::stoull(value);
+        else if(arg == "--counters")
+            config.counters = value != "0";
+        else if(arg == "--csv")
+            config.csvPath = value;
+        else
+        {
+            std::cerr << "未知参数: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printHeader()
+{
+    cout << std::left << std::setw(14) << "case" << std::setw(8) << "key"
+         << std::right << std::setw(10) << "capacity" << std::setw(14) << "iterations"
+         << std::setw(10) << "ns/op";
+    for(int i=0; i<PerfCounters::EventCount; i++)
+        cout << std::setw(15) << PerfCounters::eventName(static_cast<PerfCounters::Event>(i));
+    cout << "\n";
+}
+
+static void printResult(const MicroResult& r)
+{
+    cout << std::left << std::setw(14) << r.name << std::setw(8) << r.keyType
+         << std::right << std::setw(10) << r.capacity << std::setw(14) << r.iterations
+         << std::setw(10) << std::fixed << std::setprecision(1) << r.nsPerOp;
+    for(int i=0; i<PerfCounters::EventCount; i++)
+    {
+        if(r.hasCounter[i])
+            cout << std::setw(15) << std::setprecision(2) << r.counterPerOp[i];
+        else
+            cout << std::setw(15) << "-";
+    }
+    cout << std::endl;
+}
+
+static void writeCsv(const string& path, const std::vector<MicroResult>& results)
+{
+    std::ofstream out(path);
+    out << "case,key,capacity,iterations,ns_per_op";
+    for(int i=0; i<PerfCounters::EventCount; i++)
+        out << ',' << PerfCounters::eventName(static_cast<PerfCounters::Event>(i)) << "_per_op";
+    out << '\n';
+    for(const MicroResult& r : results)
+    {
+        out << r.name << ',' << r.keyType << ',' << r.capacity << ',' << r.iterations << ',' << r.nsPerOp;
+        for(int i=0; i<PerfCounters::EventCount; i++)
+        {
+            out << ',';
+            if(r.hasCounter[i])
+                out << r.counterPerOp[i];
+        }
+        out << '\n';
+    }
+}
+
+int main(int argc, char** argv)
+{
+    MicroConfig config;
+    if(!parseArgs(argc, argv, config))
+        return 1;
+
+    PerfCounters counters;
+    if(config.counters && !counters.open())
+        cout << "硬件计数器不可用(perf_event_open失败) 只输出ns/op\n";
+
+    printHeader();
+    std::vector<MicroResult> results;
+    for(const string& name : config.cases)
+        for(const string& keyType : config.keyTypes)
+            for(size_t capacity : config.capacities)
+            {
+                MicroResult result;
+                bool known;
+                if(keyType == "int")
+                    known = runCase<int>(config, counters, name, capacity, result);
+                else if(keyType == "string")
+                    known = runCase<string>(config, counters, name, capacity, result);
+                else
+                {
+                    std::cerr << "未知key类型: " << keyType << "\n";
+                    return 1;
+                }
+                if(!known)
+                {
+                    std::cerr << "未知用例: " << name << "\n";
+                    return 1;
+                }
+                printResult(result);
+                results.push_back(result);
+            }
+
+    if(!config.csvPath.empty())
+        writeCsv(config.csvPath, results);
+    return 0;
+}
@@ -0,0 +1,165 @@
+// 单遍LRU缺失率曲线估计(SHARDS采样)
+//
+// 用法: ShardsMRC --trace file [--format binary|oracleGeneral|csv] [csv列参数同TraceReplay]
+//                 [--rate 0.01] [--capacities 100,1000] [--capacity-range 100:1000000:20]
+//                 [--exact 0|1] [--max-requests N] [--out mrc.csv]
+//
+// --rate  采样率 1为不采样的精确Mattson栈距离
+// --exact 同时计算精确曲线并输出两者的最大绝对误差 用于验证采样率是否足够
+
+#include "ArgParse.h"
+#include "MissRatioCurve.h"
+#include "TraceReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Cache::Bench;
+using std::string, std::cout;
+
+struct MrcConfig
+{
+    string tracePath;
+    TraceFormat format = TraceFormat::Binary;
+    CsvOptions csvOptions;
+    double rate = 0.01;
+    bool exact = false;
+    std::vector<size_t> capacities;
+    uint64_t maxRequests = 0;
+    string outPath;
+};
+
+static bool parseArgs(int argc, char** argv, MrcConfig& config)
+{
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cerr << "参数缺少取值: " << arg << "\n";
+            return false;
+        }
+        string value = argv[++i];
+        if(arg == "--trace")
+            config.tracePath = value;
+        else if(arg == "--format")
+        {
+            if(!parseTraceFormat(value, config.format))
+            {
+                std::cerr << "未知轨迹格式: " << value << "\n";
+                return false;
+            }
+        }
+        else if(arg == "--csv-key-col")
+            config.csvOptions.keyColumn = std::stoi(value);
+        else if(arg == "--csv-size-col")
+            config.csvOptions.sizeColumn = std::stoi(value);
+        else if(arg == "--csv-op-col")
+            config.csvOptions.opColumn = std::stoi(value);
+        else if(arg == "--csv-header")
+            config.csvOptions.hasHeader = value != "0";
+        else if(arg == "--rate")
+            config.rate = std::stod(value);
+        else if(arg == "--exact")
+            config.exact = value != "0";
+        else if(arg == "--capacities")
+            config.capacities = parseList<size_t>(value);
+        else if(arg == "--capacity-range")
+            config.capacities = parseCapacityRange(value);
+        else if(arg == "--max-requests")
+            config.maxRequests = std::stoull(value);
+        else if(arg == "--out")
+            config.outPath = value;
+        else
+        {
+            std::cerr << "未知参数: " << arg << "\n";
+            return false;
+        }
+    }
+    if(config.tracePath.empty())
+    {
+        std::cerr << "需要指定 --trace\n";
+        return false;
+    }
+    if(config.capacities.empty())
+        config.capacities = parseCapacityRange("10:1000000:16");
+    std::sort(config.capacities.begin(), config.capacities.end());
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    MrcConfig config;
+    if(!parseArgs(argc, argv, config))
+        return 1;
+
+    TraceReader reader;
+    if(!reader.open(config.tracePath, config.format, config.csvOptions))
+    {
+        std::cerr << "无法打开轨迹: " << config.tracePath << "\n";
+        return 1;
+    }
+
+    ShardsMRC sampled(config.rate);
+    ShardsMRC exact(1.0);
+
+    auto begin = std::chrono::steady_clock::now();
+    TraceRecord record;
+    uint64_t count = 0;
+    while((config.maxRequests == 0 || count < config.maxRequests) && reader.next(record))
+    {
+        count++;
+        sampled.access(record.key);
+        if(config.exact)
+            exact.access(record.key);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<uint64_t> capacities(config.capacities.begin(), config.capacities.end());
+    auto curve = sampled.missRatioCurve(capacities);
+    std::vector<std::pair<uint64_t, double>> exactCurve;
+    if(config.exact)
+        exactCurve = exact.missRatioCurve(capacities);
+
+    cout << "请求数: " << sampled.references() << "  采样数: " << sampled.sampled()
+         << "  采样率: " << sampled.samplingRate() << "  跟踪key数: " << sampled.trackedKeys()
+         << "  耗时: " << std::fixed << std::setprecision(2) << seconds << "s\n";
+    cout << std::right << std::setw(12) << "capacity" << std::setw(12) << "miss%";
+    if(config.exact)
+        cout << std::setw(12) << "exact%";
+    cout << "\n";
+
+    double maxError = 0;
+    for(size_t i=0; i<curve.size(); i++)
+    {
+        cout << std::setw(12) << curve[i].first << std::setw(12) << curve[i].second * 100;
+        if(config.exact)
+        {
+            cout << std::setw(12) << exactCurve[i].second * 100;
+            maxError = std::max(maxError, std::fabs(curve[i].second - exactCurve[i].second));
+        }
+        cout << "\n";
+    }
+    if(config.exact)
+        cout << "最大绝对误差: " << maxError * 100 << "%\n";
+
+    if(!config.outPath.empty())
+    {
+        std::ofstream out(config.outPath);
+        out << "capacity,miss_ratio" << (config.exact ? ",exact_miss_ratio" : "") << "\n";
+        for(size_t i=0; i<curve.size(); i++)
+        {
+            out << curve[i].first << ',' << curve[i].second;
+            if(config.exact)
+                out << ',' << exactCurve[i].second;
+            out << '\n';
+        }
+    }
+    return 0;
+}
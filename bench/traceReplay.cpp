@@ -0,0 +1,268 @@
+// 轨迹回放: 用真实访问日志驱动各策略 一次遍历同时模拟多个容量 输出缺失率曲线(MRC)
+//
+// 用法: TraceReplay --trace file [--format binary|oracleGeneral|csv]
+//                   [--csv-key-col 0] [--csv-size-col -1] [--csv-op-col -1] [--csv-header 0]
+//                   [--policies LRU,LFU] [--capacities 100,1000] [--capacity-range 100:100000:10]
+//                   [--max-requests N] [--jobs N] [--out mrc.csv] [--convert out.bin]
+//
+// 每条读请求: get未命中则put(回填) 写请求直接put
+// 策略名OPT为Belady最优替换(离线) 作为命中率上界与其他策略一起输出
+// --convert 把任意支持的格式转换成紧凑二进制格式后退出
+
+#include "ArgParse.h"
+#include "Belady.h"
+#include "PolicyFactory.h"
+#include "TraceReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Cache;
+using namespace Cache::Bench;
+using std::string, std::cout;
+
+// 默认策略列表之后附加OPT
+static std::vector<string> withOptimal(std::vector<string> names)
+{
+    names.push_back("OPT");
+    return names;
+}
+
+struct ReplayConfig
+{
+    string tracePath;
+    TraceFormat format = TraceFormat::Binary;
+    CsvOptions csvOptions;
+    std::vector<string> policies = withOptimal(policyNames());
+    std::vector<size_t> capacities;
+    uint64_t maxRequests = 0;       // 0表示回放全部
+    int jobs = 1;                   // 并行线程数 每个线程负责一部分缓存实例
+    string outPath;
+    string convertPath;
+};
+
+// 一个(策略, 容量)的模拟实例
+struct Simulation
+{
+    string policy;
+    size_t capacity;
+    std::unique_ptr<Policy<uint64_t, uint32_t>> cache;    // OPT为空
+    uint64_t requests = 0;
+    uint64_t misses = 0;
+};
+
+static bool parseArgs(int argc, char** argv, ReplayConfig& config)
+{
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cerr << "参数缺少取值: " << arg << "\n";
+            return false;
+        }
+        string value = argv[++i];
+        if(arg == "--trace")
+            config.tracePath = value;
+        else if(arg == "--format")
+        {
+            if(!parseTraceFormat(value, config.format))
+            {
+                std::cerr << "未知轨迹格式: " << value << "\n";
+                return false;
+            }
+        }
+        else if(arg == "--csv-key-col")
+            config.csvOptions.keyColumn = std::stoi(value);
+        else if(arg == "--csv-size-col")
+            config.csvOptions.sizeColumn = std::stoi(value);
+        else if(arg == "--csv-op-col")
+            config.csvOptions.opColumn = std::stoi(value);
+        else if(arg == "--csv-header")
+            config.csvOptions.hasHeader = value != "0";
+        else if(arg == "--policies")
+            config.policies = parseList<string>(value);
+        else if(arg == "--capacities")
+            config.capacities = parseList<size_t>(value);
+        else if(arg == "--capacity-range")
+            config.capacities = parseCapacityRange(value);
+        else if(arg == "--max-requests")
+            config.maxRequests = std::stoull(value);
+        else if(arg == "--jobs")
+            config.jobs = std::max(1, std::stoi(value));
+        else if(arg == "--out")
+            config.outPath = value;
+        else if(arg == "--convert")
+            config.convertPath = value;
+        else
+        {
+            std::cerr << "未知参数: " << arg << "\n";
+            return false;
+        }
+    }
+    if(config.tracePath.empty())
+    {
+        std::cerr << "需要指定 --trace\n";
+        return false;
+    }
+    if(config.capacities.empty())
+        config.capacities = {100, 1000, 10000, 100000};
+    return true;
+}
+
+static int convertTrace(const ReplayConfig& config)
+{
+    TraceReader reader;
+    if(!reader.open(config.tracePath, config.format, config.csvOptions))
+    {
+        std::cerr << "无法打开轨迹: " << config.tracePath << "\n";
+        return 1;
+    }
+    std::ofstream out(config.convertPath, std::ios::binary);
+    TraceReader::writeBinaryHeader(out);
+    TraceRecord record;
+    uint64_t count = 0;
+    while((config.maxRequests == 0 || count < config.maxRequests) && reader.next(record))
+    {
+        TraceReader::writeBinaryRecord(out, record);
+        count++;
+    }
+    cout << "已转换 " << count << " 条记录 -> " << config.convertPath << "\n";
+    return 0;
+}
+
+// 单个线程: 独立遍历一遍映射文件 驱动分给它的所有实例
+static bool replay(const ReplayConfig& config, std::vector<Simulation*>& simulations)
+{
+    TraceReader reader;
+    if(!reader.open(config.tracePath, config.format, config.csvOptions))
+        return false;
+
+    TraceRecord record;
+    uint64_t count = 0;
+    uint32_t value;
+    while((config.maxRequests == 0 || count < config.maxRequests) && reader.next(record))
+    {
+        count++;
+        for(Simulation* simulation : simulations)
+        {
+            if(record.isPut)
+            {
+                simulation->cache->put(record.key, record.size);
+                continue;
+            }
+            simulation->requests++;
+            if(!simulation->cache->get(record.key, value))
+            {
+                simulation->misses++;
+                simulation->cache->put(record.key, record.size);
+            }
+        }
+    }
+    return true;
+}
+
+// OPT: 先读入整条轨迹计算下次访问位置 再对每个容量各模拟一遍
+static bool replayOptimal(const ReplayConfig& config, std::vector<Simulation*>& simulations)
+{
+    TraceReader reader;
+    if(!reader.open(config.tracePath, config.format, config.csvOptions))
+        return false;
+
+    BeladySimulator belady;
+    TraceRecord record;
+    while((config.maxRequests == 0 || belady.size() < config.maxRequests) && reader.next(record))
+        belady.add(record.key, !record.isPut);
+    belady.finalize();
+
+    for(Simulation* simulation : simulations)
+    {
+        BeladySimulator::Result result = belady.simulate(simulation->capacity);
+        simulation->requests = result.requests;
+        simulation->misses = result.requests - result.hits;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    ReplayConfig config;
+    if(!parseArgs(argc, argv, config))
+        return 1;
+    if(!config.convertPath.empty())
+        return convertTrace(config);
+
+    std::vector<Simulation> simulations;
+    for(const string& policy : config.policies)
+        for(size_t capacity : config.capacities)
+        {
+            Simulation simulation;
+            simulation.policy = policy;
+            simulation.capacity = capacity;
+            // LRU-K的历史记录暂存value 取与容量相同 缺失率曲线上各策略的内存才可比
+            if(policy != "OPT")
+                simulation.cache = makePolicy<uint64_t, uint32_t>(policy, capacity, capacity);
+            if(!simulation.cache && policy != "OPT")
+            {
+                std::cerr << "未知策略: " << policy << "\n";
+                return 1;
+            }
+            simulations.push_back(std::move(simulation));
+        }
+
+    // 按轮转把实例分给各线程 OPT单独计算
+    std::vector<Simulation*> online;
+    std::vector<Simulation*> optimal;
+    for(Simulation& simulation : simulations)
+        (simulation.cache ? online : optimal).push_back(&simulation);
+
+    int jobs = std::max(1, std::min<int>(config.jobs, online.size()));
+    std::vector<std::vector<Simulation*>> assigned(jobs);
+    for(size_t i=0; i<online.size(); i++)
+        assigned[i % jobs].push_back(online[i]);
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    std::vector<char> succeeded(jobs, 0);
+    for(int j=0; j<jobs; j++)
+        workers.emplace_back([&, j]() { succeeded[j] = replay(config, assigned[j]); });
+    for(auto& worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if(std::find(succeeded.begin(), succeeded.end(), 0) != succeeded.end() ||
+       (!optimal.empty() && !replayOptimal(config, optimal)))
+    {
+        std::cerr << "无法打开轨迹: " << config.tracePath << "\n";
+        return 1;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    cout << std::left << std::setw(13) << "policy" << std::right << std::setw(12) << "capacity"
+         << std::setw(14) << "requests" << std::setw(14) << "misses" << std::setw(12) << "miss%" << "\n";
+    for(const Simulation& s : simulations)
+    {
+        double missRatio = s.requests == 0 ? 0 : static_cast<double>(s.misses) / s.requests;
+        cout << std::left << std::setw(13) << s.policy << std::right << std::setw(12) << s.capacity
+             << std::setw(14) << s.requests << std::setw(14) << s.misses
+             << std::setw(12) << std::fixed << std::setprecision(2) << missRatio * 100 << "\n";
+    }
+    cout << "回放耗时: " << std::setprecision(2) << seconds << "s\n";
+
+    if(!config.outPath.empty())
+    {
+        std::ofstream out(config.outPath);
+        out << "policy,capacity,requests,misses,miss_ratio\n";
+        for(const Simulation& s : simulations)
+            out << s.policy << ',' << s.capacity << ',' << s.requests << ',' << s.misses << ','
+                << (s.requests == 0 ? 0 : static_cast<double>(s.misses) / s.requests) << '\n';
+    }
+    return 0;
+}
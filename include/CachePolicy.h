@@ -1,4 +1,14 @@
 #pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "CacheStats.h"
+#include "KeyRef.h"
+#include "LatencyHistogram.h"
+
 namespace Cache
 {
 
@@ -6,19 +16,108 @@ template<typename Key, typename Value>
 class Policy
 {
 public:
+    // 查找参数类型: std::string的key可直接用std::string_view查找 不构造临时string
+    using LookupType = typename KeyTraits<Key>::LookupType;
+
+    // 驱逐监听: 条目因容量被驱逐时以(key, value)调用 -> 可把被驱逐的条目转存到下一级缓存
+    // 在缓存锁内调用 应尽快返回且不得再访问本缓存
+    using EvictionListener = std::function<void(const Key&, const Value&)>;
+
     // 虚析构 派生类正确析构
     virtual ~Policy() {};
 
     // 添加放入页接口
-    virtual void put(Key key, Value value) = 0;
+    // 右值版本把value移动进缓存结点 不再拷贝
+    virtual void put(const Key& key, const Value& value) = 0;
+    virtual void put(const Key& key, Value&& value) = 0;
+
+    // 用args构造value后放入 -> 只有一次移动
+    template<typename... Args>
+    void emplace(const Key& key, Args&&... args)
+    {
+        put(key, Value(std::forward<Args>(args)...));
+    }
 
     // 获取页接口
     // 直接在传入引用中修改
-    virtual bool get(Key key, Value &value) = 0;
+    virtual bool get(LookupType key, Value &value) = 0;
     // 返回Value 无则返回nullptr
-    virtual Value get(Key key) = 0;
+    virtual Value get(LookupType key) = 0;
+
+    // 统计快照 分片缓存汇总所有分片
+    virtual CacheStats stats() const { return statsCounter.snapshot(); }
+
+    // 记录一次数据源加载 分片缓存记录到key所在分片
+    virtual void recordLoad(const Key& /*key*/, bool success, uint64_t nanos)
+    {
+        statsCounter.record(success ? StatsCounter::LoadSuccess : StatsCounter::LoadFailure);
+        statsCounter.record(StatsCounter::LoadNanos, nanos);
+    }
+
+    // 获取页 未命中时调用loader(key, value)从数据源加载 加载成功则放入缓存
+    // 返回值表示最终是否取得value
+    template<typename Loader>
+    bool getOrLoad(const Key& key, Value& value, Loader&& loader)
+    {
+        if(get(key, value))
+            return true;
+
+        // 开启延迟记录时与直方图共用CycleClock; 否则只为加载统计计时 用steady_clock 不触发CycleClock校准
+        uint64_t nanos;
+        bool success;
+        if(latencyRecorder)
+        {
+            uint64_t start = CycleClock::now();
+            success = loader(key, value);
+            nanos = CycleClock::toNanos(CycleClock::now() - start);
+            latencyRecorder->record(LatencyRecorder::Load, nanos);
+        }
+        else
+        {
+            auto start = std::chrono::steady_clock::now();
+            success = loader(key, value);
+            nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+        recordLoad(key, success, nanos);
+
+        if(success)
+            put(key, value);
+        return success;
+    }
+
+    // 开启get/put/加载的延迟记录(需在并发访问前调用)
+    // sampleShift: 每2^sampleShift次操作采样一次 默认全部记录
+    void enableLatency(unsigned sampleShift = 0)
+    {
+        latencyRecorder.reset(new LatencyRecorder(sampleShift));
+    }
+
+    // 设置驱逐监听(需在并发访问前调用) 分片缓存转给每个分片
+    virtual void setEvictionListener(EvictionListener listener)
+    {
+        evictionListener = std::move(listener);
+    }
+
+    // 合并各线程直方图后的延迟分布 未开启时为空
+    HistogramSnapshot latency(LatencyRecorder::Op op) const
+    {
+        return latencyRecorder ? latencyRecorder->snapshot(op) : HistogramSnapshot();
+    }
+
+protected:
+    // 命中/未命中/放入/驱逐等计数
+    mutable StatsCounter statsCounter;
+    // 延迟直方图 默认关闭(为空)
+    std::unique_ptr<LatencyRecorder> latencyRecorder;
+    // 驱逐监听 默认为空
+    EvictionListener evictionListener;
 
+    void notifyEviction(const Key& key, const Value& value)
+    {
+        if(evictionListener)
+            evictionListener(key, value);
+    }
 
 };
 
-}   // namespace Cache
\ No newline at end of file
+}   // namespace Cache
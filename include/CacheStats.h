@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Cache
+{
+
+// 缓存统计快照 -> 由stats()返回 各字段为累计值
+struct CacheStats
+{
+    uint64_t hits = 0;              // 命中次数
+    uint64_t misses = 0;            // 未命中次数
+    uint64_t puts = 0;              // 放入次数
+    uint64_t evictions = 0;         // 驱逐次数
+    uint64_t loadSuccesses = 0;     // 从数据源加载成功次数
+    uint64_t loadFailures = 0;      // 从数据源加载失败次数
+    uint64_t totalLoadNanos = 0;    // 加载总耗时(纳秒)
+
+    double hitRate() const
+    {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+
+    double averageLoadNanos() const
+    {
+        uint64_t loads = loadSuccesses + loadFailures;
+        return loads == 0 ? 0.0 : static_cast<double>(totalLoadNanos) / loads;
+    }
+
+    CacheStats& operator+=(const CacheStats& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        puts += other.puts;
+        evictions += other.evictions;
+        loadSuccesses += other.loadSuccesses;
+        loadFailures += other.loadFailures;
+        totalLoadNanos += other.totalLoadNanos;
+        return *this;
+    }
+};
+
+namespace detail
+{
+// 线程槽位编号: 每个线程第一次调用时分配一个递增编号 之后固定不变
+inline unsigned threadSlot()
+{
+    static std::atomic<unsigned> nextSlot{0};
+    thread_local unsigned slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+}   // namespace detail
+
+// 分条计数器: 每个线程按槽位写入各自的缓存行 读取时汇总
+// 热路径上只有一次relaxed原子加 不同线程之间不争用同一缓存行
+class StatsCounter
+{
+public:
+    enum Field
+    {
+        Hit,
+        Miss,
+        Put,
+        Eviction,
+        LoadSuccess,
+        LoadFailure,
+        LoadNanos,
+        FieldCount
+    };
+
+    StatsCounter() { reset(); }
+
+    StatsCounter(const StatsCounter&) = delete;
+    StatsCounter& operator=(const StatsCounter&) = delete;
+
+    void record(Field field, uint64_t num = 1)
+    {
+        Stripe& stripe = stripes[detail::threadSlot() % StripeNum];
+        stripe.values[field].fetch_add(num, std::memory_order_relaxed);
+    }
+
+    // 汇总所有分条得到快照
+    CacheStats snapshot() const
+    {
+        uint64_t sum[FieldCount] = {};
+        for(const Stripe& stripe : stripes)
+            for(int i=0; i<FieldCount; i++)
+                sum[i] += stripe.values[i].load(std::memory_order_relaxed);
+
+        CacheStats stats;
+        stats.hits = sum[Hit];
+        stats.misses = sum[Miss];
+        stats.puts = sum[Put];
+        stats.evictions = sum[Eviction];
+        stats.loadSuccesses = sum[LoadSuccess];
+        stats.loadFailures = sum[LoadFailure];
+        stats.totalLoadNanos = sum[LoadNanos];
+        return stats;
+    }
+
+    void reset()
+    {
+        for(Stripe& stripe : stripes)
+            for(auto& value : stripe.values)
+                value.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t StripeNum = 8;
+
+    // 一个分条恰好占满一个缓存行 避免伪共享
+    struct alignas(64) Stripe
+    {
+        std::atomic<uint64_t> values[FieldCount];
+    };
+
+    Stripe stripes[StripeNum];
+};
+
+}   // namespace Cache
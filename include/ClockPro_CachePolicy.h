@@ -0,0 +1,333 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<cstdint>
+#include<limits>
+#include<memory>
+#include<mutex>
+#include<shared_mutex>
+
+#include "CachePolicy.h"
+#include "KeyRef.h"
+
+namespace Cache
+{
+
+// CLOCK-Pro: 用一个环和三根指针近似LIRS的冷热划分 命中只置引用位 不移动任何结点
+// - 环上有三类页: 热页(hot) 冷页(cold, 常驻) 测试页(test, 已淘汰的冷页 只存key)
+// - handCold: 扫过冷页时 引用位为1则升为热页 否则淘汰为测试页
+// - handHot: 热页超过目标数量时运行 引用位为1则清零 否则降为冷页
+// - handTest: 测试页超过容量时运行 删除过期的测试页 并减小冷页目标数量
+// - 测试期内再次放入的key说明重用距离短 直接成为热页 同时增大冷页目标数量(自适应)
+// 环为数组下标串起的双向链表 结点连续存放在一块数组中; get在共享锁下只读value、置引用位 多个读者不互斥
+template<typename Key, typename Value>
+class ClockProCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+    static constexpr uint32_t Nil = std::numeric_limits<uint32_t>::max();
+
+    enum Type : unsigned char
+    {
+        Empty,
+        Hot,
+        Cold,
+        Test
+    };
+
+    struct Page
+    {
+        Key key{};
+        Value value{};
+        uint32_t prev = Nil;
+        uint32_t next = Nil;
+        std::atomic<bool> referenced{false};
+        Type type = Empty;
+    };
+
+private:
+    size_t capacity;                    // 常驻页(热 + 冷)上限 测试页上限与之相同
+    size_t coldTarget;                  // 冷页目标数量 热页目标为capacity - coldTarget
+    size_t hotCount;
+    size_t coldCount;
+    size_t testCount;
+    std::unique_ptr<Page[]> pages;      // 2 * capacity个 常驻与测试页各至多capacity个
+    uint32_t freeList;                  // 空闲页(经next相连)
+    uint32_t handHot;
+    uint32_t handCold;
+    uint32_t handTest;
+    KeyRefMap<Key, uint32_t> index;     // key引用页中的key
+    mutable std::shared_mutex mutex_;
+
+    // 插入到handHot之前(环的"头部")
+    void link(uint32_t page)
+    {
+        if(handHot == Nil)
+        {
+            pages[page].prev = pages[page].next = page;
+            handHot = handCold = handTest = page;
+            return;
+        }
+        uint32_t before = pages[handHot].prev;
+        pages[page].prev = before;
+        pages[page].next = handHot;
+        pages[before].next = page;
+        pages[handHot].prev = page;
+        if(handCold == handHot)
+            handCold = page;
+    }
+
+    // 从环中摘出 指向它的指针退回前一页(随后各自前进时正好到达其后一页)
+    void unlink(uint32_t page)
+    {
+        uint32_t prev = pages[page].prev;
+        uint32_t next = pages[page].next;
+        if(prev == page)
+        {
+            handHot = handCold = handTest = Nil;
+        }
+        else
+        {
+            if(handHot == page)
+                handHot = prev;
+            if(handCold == page)
+                handCold = prev;
+            if(handTest == page)
+                handTest = prev;
+            pages[prev].next = next;
+            pages[next].prev = prev;
+        }
+        pages[page].prev = pages[page].next = Nil;
+    }
+
+    // 删除测试页或被移除的页: 摘出环、删去索引、归还空闲表
+    void release(uint32_t page)
+    {
+        Page& p = pages[page];
+        unlink(page);
+        index.erase(p.key);
+        p.value = Value{};
+        p.type = Empty;
+        p.next = freeList;
+        freeList = page;
+    }
+
+    // 为新常驻页腾出位置
+    void evict()
+    {
+        while(hotCount + coldCount >= capacity)
+            runHandCold();
+    }
+
+    // 冷页指针: 前进到下一个冷页 有引用则升为热页 否则淘汰为测试页
+    // 没有冷页时先由热页指针降级 各指针只前进 每步都改变一页的状态或清除一个引用位 不会无限循环
+    void runHandCold()
+    {
+        while(coldCount == 0)
+            runHandHot();
+        while(pages[handCold].type != Cold)
+            handCold = pages[handCold].next;
+        Page& p = pages[handCold];
+        handCold = p.next;
+        if(p.referenced.load(std::memory_order_relaxed))
+        {
+            // 测试期内被访问 -> 升为热页
+            p.type = Hot;
+            p.referenced.store(false, std::memory_order_relaxed);
+            coldCount--;
+            hotCount++;
+            while(hotCount > capacity - coldTarget)
+                runHandHot();
+        }
+        else
+        {
+            // 未被访问 -> 淘汰value 保留key作为测试页
+            this->statsCounter.record(StatsCounter::Eviction);
+            this->notifyEviction(p.key, p.value);
+            p.type = Test;
+            p.value = Value{};
+            coldCount--;
+            testCount++;
+            while(testCount > capacity)
+                runHandTest();
+        }
+    }
+
+    // 热页指针: 有引用则清除 否则降为冷页; 途经的测试页一并删除(其测试期已不短于热页的重用距离)
+    void runHandHot()
+    {
+        uint32_t page = handHot;
+        Page& p = pages[page];
+        if(p.type == Hot)
+        {
+            if(p.referenced.load(std::memory_order_relaxed))
+                p.referenced.store(false, std::memory_order_relaxed);
+            else
+            {
+                p.type = Cold;
+                hotCount--;
+                coldCount++;
+            }
+        }
+        else if(p.type == Test)
+        {
+            expireTest(page);
+        }
+        handHot = pages[handHot].next;
+    }
+
+    // 测试页指针: 前进到下一个测试页并删除
+    void runHandTest()
+    {
+        while(pages[handTest].type != Test)
+            handTest = pages[handTest].next;
+        expireTest(handTest);
+        handTest = pages[handTest].next;
+    }
+
+    // 测试期满仍未被访问 -> 删除 冷页目标减小
+    void expireTest(uint32_t page)
+    {
+        release(page);
+        testCount--;
+        if(coldTarget > 1)
+            coldTarget--;
+    }
+
+    template<typename V>
+    void putValue(const Key& key, V&& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity == 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it != index.end())
+        {
+            uint32_t page = it->second;
+            Page& p = pages[page];
+            if(p.type != Test)
+            {
+                p.value = std::forward<V>(value);
+                p.referenced.store(true, std::memory_order_relaxed);
+                return;
+            }
+            // 测试页再次放入 -> 重用距离短 增大冷页目标 作为热页重新放到环头部
+            if(coldTarget < capacity)
+                coldTarget++;
+            unlink(page);
+            testCount--;
+            evict();
+            p.type = Hot;
+            p.referenced.store(false, std::memory_order_relaxed);
+            p.value = std::forward<V>(value);
+            hotCount++;
+            link(page);
+            return;
+        }
+
+        evict();
+        uint32_t page = freeList;
+        Page& p = pages[page];
+        freeList = p.next;
+        p.key = key;
+        p.value = std::forward<V>(value);
+        p.referenced.store(false, std::memory_order_relaxed);
+        // 冷启动: 热页未达目标数量时新页直接成为热页(同LIRS)
+        if(hotCount < capacity - coldTarget)
+        {
+            p.type = Hot;
+            hotCount++;
+        }
+        else
+        {
+            p.type = Cold;
+            coldCount++;
+        }
+        link(page);
+        index.emplace(p.key, page);
+    }
+
+public:
+    explicit ClockProCache(int capacity)
+        : capacity(static_cast<size_t>(std::max(capacity, 0)))
+        , coldTarget(std::max<size_t>(1, this->capacity / 100))
+        , hotCount(0)
+        , coldCount(0)
+        , testCount(0)
+        , pages(new Page[this->capacity * 2])
+        , freeList(this->capacity > 0 ? 0 : Nil)
+        , handHot(Nil)
+        , handCold(Nil)
+        , handTest(Nil)
+    {
+        for(size_t i=0; i<this->capacity * 2; i++)
+            pages[i].next = i + 1 < this->capacity * 2 ? static_cast<uint32_t>(i + 1) : Nil;
+    }
+
+    ~ClockProCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    // 共享锁下读取 命中只置引用位(已置位时不再写)
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end() || pages[it->second].type == Test)
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        Page& p = pages[it->second];
+        if(!p.referenced.load(std::memory_order_relaxed))
+            p.referenced.store(true, std::memory_order_relaxed);
+        value = p.value;
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定页(同时删去测试页)
+    void remove(LookupType key)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+            return;
+        uint32_t page = it->second;
+        Type type = pages[page].type;
+        (type == Hot ? hotCount : type == Cold ? coldCount : testCount)--;
+        release(page);
+    }
+
+    // 常驻页数
+    size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return hotCount + coldCount;
+    }
+
+    size_t hotSize() const { std::shared_lock<std::shared_mutex> lock(mutex_); return hotCount; }
+    size_t coldSize() const { std::shared_lock<std::shared_mutex> lock(mutex_); return coldCount; }
+    size_t testSize() const { std::shared_lock<std::shared_mutex> lock(mutex_); return testCount; }
+    size_t coldTargetSize() const { std::shared_lock<std::shared_mutex> lock(mutex_); return coldTarget; }
+};
+
+}   // namespace Cache
@@ -0,0 +1,305 @@
+#pragma once
+
+#include<cstdint>
+#include<limits>
+#include<mutex>
+#include<vector>
+
+#include "CachePolicy.h"
+#include "CompactStorage.h"
+
+namespace Cache
+{
+
+// 紧凑LRU: 与LRUCache淘汰顺序完全一致 每个条目的内存开销从约150字节降到几十字节
+// - 索引为开放寻址(线性探测)哈希表 槽内直接存key与条目下标 删除时后移回填 不留墓碑
+// - 条目连续存放在一个数组中 前后指针为32位下标 不使用shared_ptr与单独分配的结点
+// - value可平凡复制时原样保存 std::string不超过23字节时内联 更长的放入带长度前缀的堆内存
+// 要求key可平凡复制 value可平凡复制或为std::string
+template<typename Key, typename Value>
+class CompactLRUCache : public Policy<Key, Value>
+{
+    static_assert(IsCompactStorable<Key, Value>::value,
+                  "CompactLRUCache要求key可平凡复制 value可平凡复制或为std::string");
+
+    using LookupType = typename Policy<Key, Value>::LookupType;
+    static constexpr uint32_t Null = std::numeric_limits<uint32_t>::max();
+
+    // 索引槽: key内联 entry为Null表示空槽
+    struct Slot
+    {
+        Key key;
+        uint32_t entry;
+    };
+
+    // 条目: LRU链表前后下标 + 所在索引槽 + value
+    struct Entry
+    {
+        uint32_t prev;
+        uint32_t next;
+        uint32_t slot;
+        CompactValue<Value> value;
+    };
+
+private:
+    int capacity;
+    std::vector<Slot> slots;            // 槽数为2的幂 装载因子不超过0.7
+    size_t slotMask;
+    std::vector<Entry> entries;         // 预留capacity个 只增不减 被删除的条目进入空闲链表
+    uint32_t freeList;                  // 空闲条目链表(经next相连)
+    uint32_t oldest;                    // 最近最久未使用
+    uint32_t newest;                    // 最近使用
+    size_t count;
+    size_t heapBytes;                   // value溢出到堆上的字节数
+    std::mutex mutex_;
+
+    // 整数key的std::hash通常是恒等映射 线性探测需要再混合一次
+    static size_t mix(size_t hash)
+    {
+        uint64_t h = hash;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    size_t home(const Key& key) const
+    {
+        return mix(typename KeyTraits<Key>::Hasher()(key)) & slotMask;
+    }
+
+    // 查找key所在槽 不存在返回Null
+    uint32_t findSlot(const Key& key) const
+    {
+        for(size_t i = home(key); ; i = (i + 1) & slotMask)
+        {
+            const Slot& slot = slots[i];
+            if(slot.entry == Null)
+                return Null;
+            if(slot.key == key)
+                return static_cast<uint32_t>(i);
+        }
+    }
+
+    // 删除槽i: 把后面探测链上的槽前移补位 保证查找不会提前遇到空槽而中断
+    void eraseSlot(size_t i)
+    {
+        size_t j = i;
+        while(true)
+        {
+            j = (j + 1) & slotMask;
+            if(slots[j].entry == Null)
+                break;
+            size_t k = home(slots[j].key);
+            // k不在(i, j]区间内(环形) -> 槽j可以前移到i
+            bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+            if(stays)
+                continue;
+            slots[i] = slots[j];
+            entries[slots[i].entry].slot = static_cast<uint32_t>(i);
+            i = j;
+        }
+        slots[i].entry = Null;
+    }
+
+    void unlink(uint32_t index)
+    {
+        Entry& entry = entries[index];
+        if(entry.prev != Null)
+            entries[entry.prev].next = entry.next;
+        else
+            oldest = entry.next;
+        if(entry.next != Null)
+            entries[entry.next].prev = entry.prev;
+        else
+            newest = entry.prev;
+    }
+
+    void linkNewest(uint32_t index)
+    {
+        Entry& entry = entries[index];
+        entry.prev = newest;
+        entry.next = Null;
+        if(newest != Null)
+            entries[newest].next = index;
+        else
+            oldest = index;
+        newest = index;
+    }
+
+    void moveToNewest(uint32_t index)
+    {
+        if(index == newest)
+            return;
+        unlink(index);
+        linkNewest(index);
+    }
+
+    // 移除条目: 断开链表、删除索引槽、放回空闲链表
+    void removeEntry(uint32_t index)
+    {
+        Entry& entry = entries[index];
+        unlink(index);
+        eraseSlot(entry.slot);
+        heapBytes -= entry.value.heapBytes();
+        entry.value = CompactValue<Value>();
+        entry.next = freeList;
+        freeList = index;
+        count--;
+    }
+
+    void removeLeastRecent()
+    {
+        // 条目内只有紧凑形式 有监听时才还原出key与value
+        if(this->evictionListener)
+        {
+            Value value;
+            entries[oldest].value.load(value);
+            Key key = slots[entries[oldest].slot].key;
+            removeEntry(oldest);
+            this->notifyEviction(key, value);
+        }
+        else
+            removeEntry(oldest);
+        this->statsCounter.record(StatsCounter::Eviction);
+    }
+
+    uint32_t allocateEntry()
+    {
+        if(freeList != Null)
+        {
+            uint32_t index = freeList;
+            freeList = entries[index].next;
+            return index;
+        }
+        entries.emplace_back();
+        return static_cast<uint32_t>(entries.size() - 1);
+    }
+
+    void putValue(const Key& key, const Value& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity <= 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = findSlot(key);
+        if(slot != Null)
+        {
+            // 已存在 -> 覆写value并移到最近使用
+            Entry& entry = entries[slots[slot].entry];
+            heapBytes -= entry.value.heapBytes();
+            entry.value.assign(value);
+            heapBytes += entry.value.heapBytes();
+            moveToNewest(slots[slot].entry);
+            return;
+        }
+
+        if(count >= static_cast<size_t>(capacity))
+            removeLeastRecent();
+
+        uint32_t index = allocateEntry();
+        size_t i = home(key);
+        while(slots[i].entry != Null)
+            i = (i + 1) & slotMask;
+        slots[i].key = key;
+        slots[i].entry = index;
+
+        Entry& entry = entries[index];
+        entry.slot = static_cast<uint32_t>(i);
+        entry.value.assign(value);
+        heapBytes += entry.value.heapBytes();
+        linkNewest(index);
+        count++;
+    }
+
+public:
+    explicit CompactLRUCache(int capacity)
+        : capacity(capacity > 0 ? capacity : 0)
+        , freeList(Null)
+        , oldest(Null)
+        , newest(Null)
+        , count(0)
+        , heapBytes(0)
+    {
+        // 槽数取不小于 capacity / 0.7 的2的幂 至少留一个空槽保证探测终止
+        size_t slotCount = 2;
+        while(slotCount * 7 < static_cast<size_t>(this->capacity) * 10 + 7)
+            slotCount <<= 1;
+        slots.resize(slotCount);
+        for(Slot& slot : slots)
+            slot.entry = Null;
+        slotMask = slotCount - 1;
+        entries.reserve(this->capacity);
+    }
+
+    ~CompactLRUCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    // 紧凑存储总要把内容复制进自己的布局 右值与左值相同
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, value);
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = findSlot(key);
+        if(slot == Null)
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        uint32_t index = slots[slot].entry;
+        moveToNewest(index);
+        entries[index].value.load(value);
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = findSlot(key);
+        if(slot != Null)
+            removeEntry(slots[slot].entry);
+    }
+
+    bool contains(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return findSlot(key) != Null;
+    }
+
+    int getCapacity() const { return capacity; }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count;
+    }
+
+    // 已占用的内存(字节): 索引槽 + 已使用的条目 + value溢出到堆上的部分
+    size_t memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return slots.size() * sizeof(Slot) + entries.size() * sizeof(Entry) + heapBytes;
+    }
+};
+
+}   // namespace Cache
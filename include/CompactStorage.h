@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Cache
+{
+
+// 紧凑字符串: 共24字节且按1字节对齐 不超过23字节的内容直接存在对象内
+// 更长的内容放在一块带长度前缀的堆内存中(uint32长度 + 字节) 对象内只留指针
+class CompactString
+{
+public:
+    static constexpr size_t InlineCapacity = 23;
+
+    CompactString() : tag(0) {}
+    ~CompactString() { release(); }
+
+    CompactString(const CompactString&) = delete;
+    CompactString& operator=(const CompactString&) = delete;
+
+    CompactString(CompactString&& other) noexcept
+    {
+        std::memcpy(static_cast<void*>(this), &other, sizeof(CompactString));
+        other.tag = 0;
+    }
+
+    CompactString& operator=(CompactString&& other) noexcept
+    {
+        if(this != &other)
+        {
+            release();
+            std::memcpy(static_cast<void*>(this), &other, sizeof(CompactString));
+            other.tag = 0;
+        }
+        return *this;
+    }
+
+    void assign(const char* data, size_t size)
+    {
+        if(size <= InlineCapacity)
+        {
+            release();
+            std::memcpy(bytes, data, size);
+            tag = static_cast<uint8_t>(size);
+            return;
+        }
+        // 已在堆上且长度不变 -> 原地覆写
+        if(tag == HeapTag && heapSize() == size)
+        {
+            std::memcpy(heap() + sizeof(uint32_t), data, size);
+            return;
+        }
+        release();
+        char* block = static_cast<char*>(std::malloc(sizeof(uint32_t) + size));
+        uint32_t length = static_cast<uint32_t>(size);
+        std::memcpy(block, &length, sizeof(uint32_t));
+        std::memcpy(block + sizeof(uint32_t), data, size);
+        std::memcpy(bytes, &block, sizeof(char*));
+        tag = HeapTag;
+    }
+
+    const char* data() const { return tag == HeapTag ? heap() + sizeof(uint32_t) : bytes; }
+    size_t size() const { return tag == HeapTag ? heapSize() : tag; }
+
+    // 对象之外占用的堆内存
+    size_t heapBytes() const { return tag == HeapTag ? sizeof(uint32_t) + heapSize() : 0; }
+
+private:
+    static constexpr uint8_t HeapTag = 0xFF;
+
+    char bytes[InlineCapacity];     // 内联内容 或 堆内存指针(不对齐存放)
+    uint8_t tag;                    // 0~23: 内联长度  HeapTag: 在堆上
+
+    char* heap() const
+    {
+        char* block;
+        std::memcpy(&block, bytes, sizeof(char*));
+        return block;
+    }
+
+    size_t heapSize() const
+    {
+        uint32_t length;
+        std::memcpy(&length, heap(), sizeof(uint32_t));
+        return length;
+    }
+
+    void release()
+    {
+        if(tag == HeapTag)
+            std::free(heap());
+        tag = 0;
+    }
+};
+
+static_assert(sizeof(CompactString) == 24, "CompactString应为24字节");
+
+// Value在紧凑结点中的存储方式: 可平凡复制的类型原样保存 std::string用CompactString
+template<typename Value, typename = void>
+struct CompactValue;
+
+template<typename Value>
+struct CompactValue<Value, typename std::enable_if<std::is_trivially_copyable<Value>::value>::type>
+{
+    Value value{};
+
+    void assign(const Value& newValue) { value = newValue; }
+    void load(Value& out) const { out = value; }
+    size_t heapBytes() const { return 0; }
+};
+
+template<>
+struct CompactValue<std::string>
+{
+    CompactString value;
+
+    void assign(const std::string& newValue) { value.assign(newValue.data(), newValue.size()); }
+    void load(std::string& out) const { out.assign(value.data(), value.size()); }
+    size_t heapBytes() const { return value.heapBytes(); }
+};
+
+// 是否可用紧凑存储: key需可平凡复制(内联进索引槽) value需可平凡复制或为std::string
+template<typename Key, typename Value>
+struct IsCompactStorable
+    : std::integral_constant<bool, std::is_trivially_copyable<Key>::value &&
+                                   (std::is_trivially_copyable<Value>::value || std::is_same<Value, std::string>::value)>
+{};
+
+}   // namespace Cache
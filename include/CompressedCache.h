@@ -0,0 +1,231 @@
+#pragma once
+
+#include<atomic>
+#include<cstdint>
+#include<cstring>
+#include<limits>
+#include<memory>
+#include<mutex>
+#include<string>
+#include<type_traits>
+#include<utility>
+
+#include "CachePolicy.h"
+#include "LRU_CachePolicy.h"
+#include "LZCodec.h"
+
+namespace Cache
+{
+
+// 透明压缩: 包装任意value为std::string的策略 不小于threshold字节的value压缩后再放入
+// - 存放格式: 未压缩 [内容][Raw]  压缩 [LZ块][原始长度 u32][Compressed] 标记字节放在末尾 未压缩的右值可直接追加后移动
+// - 压缩节省不足1/8时按原样存放 避免不可压缩内容白白付出解压开销
+// - 包装SegmentLRUCache时按压缩后的字节计入内存预算 同样内存可容纳更多条目
+// - hotCapacity > 0 时另设一个存放解压结果的小LRU 读多的key命中它时不再重复解压
+//   热层命中不刷新被包装策略中的访问顺序 热层容量应远小于被包装策略
+template<typename Key, typename Value>
+class CompressedCache : public Policy<Key, Value>
+{
+    static_assert(std::is_same<Value, std::string>::value, "CompressedCache的value须为std::string");
+
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    enum Tag : char
+    {
+        Raw = 0,
+        Compressed = 1
+    };
+    static constexpr size_t CompressedTrailer = sizeof(uint32_t) + 1;
+
+private:
+    std::unique_ptr<Policy<Key, Value>> cache;      // 保存编码后value的策略
+    size_t threshold;
+    std::unique_ptr<LRUCache<Key, Value>> hot;      // 解压结果热层 未开启时为空
+    std::mutex hotMutex_;
+    std::atomic<uint64_t> writes;                   // 写入次数 用于丢弃与写入并发的热层提升
+    std::atomic<uint64_t> rawBytes;                 // 放入的原始字节
+    std::atomic<uint64_t> storedBytes;              // 编码后实际存放的字节
+
+    // 各线程复用的压缩/读取缓冲区
+    static std::string& scratch()
+    {
+        static thread_local std::string buffer;
+        return buffer;
+    }
+
+    // 压缩value到stored 收益不足时返回false
+    bool encode(const Value& value, Value& stored)
+    {
+        if(value.size() < threshold || value.size() > std::numeric_limits<uint32_t>::max())
+            return false;
+        std::string& buffer = scratch();
+        size_t bound = LZ::maxCompressedSize(value.size());
+        if(buffer.size() < bound)
+            buffer.resize(bound);
+        size_t size = LZ::compress(value.data(), value.size(), &buffer[0]);
+        if(size + CompressedTrailer > value.size() - value.size() / 8)
+            return false;
+        uint32_t rawSize = static_cast<uint32_t>(value.size());
+        stored.reserve(size + CompressedTrailer);
+        stored.assign(buffer.data(), size);
+        stored.append(reinterpret_cast<const char*>(&rawSize), sizeof(rawSize));
+        stored.push_back(Compressed);
+        return true;
+    }
+
+    // 还原被包装策略取出的value 原地去掉末尾标记或解压到value
+    bool decode(Value& value, bool& compressed)
+    {
+        if(value.empty())
+            return false;
+        compressed = value.back() == Compressed;
+        if(!compressed)
+        {
+            value.pop_back();
+            return true;
+        }
+        if(value.size() < CompressedTrailer)
+            return false;
+        std::string& stored = scratch();
+        stored.swap(value);
+        uint32_t rawSize;
+        std::memcpy(&rawSize, stored.data() + stored.size() - CompressedTrailer, sizeof(rawSize));
+        value.resize(rawSize);
+        return LZ::decompress(stored.data(), stored.size() - CompressedTrailer, &value[0], rawSize);
+    }
+
+    void store(const Key& key, Value&& stored, size_t raw)
+    {
+        rawBytes.fetch_add(raw, std::memory_order_relaxed);
+        storedBytes.fetch_add(stored.size(), std::memory_order_relaxed);
+        cache->put(key, std::move(stored));
+        invalidate(key);
+    }
+
+    // 写入后使热层中的旧值失效 并让此前开始的读取放弃提升
+    void invalidate(const Key& key)
+    {
+        if(!hot)
+            return;
+        std::lock_guard<std::mutex> lock(hotMutex_);
+        writes.fetch_add(1, std::memory_order_release);
+        hot->remove(key);
+    }
+
+    // 解压结果放入热层 读取期间发生过写入则放弃(value可能已过期)
+    void promote(LookupType key, const Value& value, uint64_t seenWrites)
+    {
+        std::lock_guard<std::mutex> lock(hotMutex_);
+        if(writes.load(std::memory_order_relaxed) == seenWrites)
+            hot->put(Key(key), value);
+    }
+
+public:
+    // cache: 被包装的策略   threshold: 不小于该字节数的value才尝试压缩   hotCapacity: 解压结果热层容量 0为不开启
+    explicit CompressedCache(std::unique_ptr<Policy<Key, Value>> cache, size_t threshold = 128, int hotCapacity = 0)
+        : cache(std::move(cache))
+        , threshold(threshold)
+        , hot(hotCapacity > 0 ? new LRUCache<Key, Value>(hotCapacity) : nullptr)
+        , writes(0)
+        , rawBytes(0)
+        , storedBytes(0)
+    {}
+
+    ~CompressedCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        this->statsCounter.record(StatsCounter::Put);
+        Value stored;
+        if(!encode(value, stored))
+        {
+            stored.reserve(value.size() + 1);
+            stored.assign(value);
+            stored.push_back(Raw);
+        }
+        store(key, std::move(stored), value.size());
+    }
+
+    // 不压缩时在原字符串末尾追加标记后移动进去
+    void put(const Key& key, Value&& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        this->statsCounter.record(StatsCounter::Put);
+        size_t raw = value.size();
+        Value stored;
+        if(encode(value, stored))
+        {
+            store(key, std::move(stored), raw);
+            return;
+        }
+        value.push_back(Raw);
+        store(key, std::move(value), raw);
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        if(hot && hot->get(key, value))
+        {
+            this->statsCounter.record(StatsCounter::Hit);
+            return true;
+        }
+        uint64_t seenWrites = writes.load(std::memory_order_acquire);
+        bool compressed = false;
+        if(!cache->get(key, value) || !decode(value, compressed))
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        if(compressed && hot)
+            promote(key, value, seenWrites);
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 被包装策略驱逐时还原出原始value再交给监听
+    void setEvictionListener(typename Policy<Key, Value>::EvictionListener listener) override
+    {
+        if(!listener)
+        {
+            cache->setEvictionListener(nullptr);
+            return;
+        }
+        cache->setEvictionListener([this, listener](const Key& key, const Value& stored)
+        {
+            Value value(stored);
+            bool compressed;
+            if(decode(value, compressed))
+                listener(key, value);
+        });
+    }
+
+    // 命中/放入按本层统计(含热层命中) 驱逐取自被包装策略
+    CacheStats stats() const override
+    {
+        CacheStats result = this->statsCounter.snapshot();
+        CacheStats inner = cache->stats();
+        result.evictions = inner.evictions;
+        return result;
+    }
+
+    // 被包装的策略 可查看其容量、内存占用等 不应绕过本层直接放入
+    Policy<Key, Value>& backing() { return *cache; }
+
+    // 累计放入的原始字节 / 实际存放的字节
+    double compressionRatio() const
+    {
+        uint64_t stored = storedBytes.load(std::memory_order_relaxed);
+        return stored == 0 ? 1.0 : static_cast<double>(rawBytes.load(std::memory_order_relaxed)) / stored;
+    }
+};
+
+}   // namespace Cache
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "KeyRef.h"
+#include "Serializer.h"
+
+namespace Cache
+{
+
+// 闪存(本地SSD)二级缓存: 条目编码后写入文件 内存中只保留key -> 文件位置的索引
+// - 日志结构: 文件按regionSize分成若干区域 条目追加到内存中的写缓冲 写满一个区域后由后台线程一次pwrite顺序写出
+//   写缓冲有两块 一块接收新条目 一块正在写出; 两块都忙时新条目直接丢弃 不阻塞调用者
+// - 区域循环使用(FIFO): 写到一个旧区域前先从索引中删去其中的条目 区域代数加一
+// - 读取在锁外pread 读完后核对区域代数 期间区域被覆写则按未命中处理; 尚未写出的条目直接从写缓冲读取
+// - 写出后提示内核丢弃页缓存 不与一级缓存争用内存
+// 缓存文件在给定目录中匿名创建(O_TMPFILE 不支持时mkstemp生成唯一文件名后立即unlink) 不会覆盖或删除已有文件
+// 进程退出后空间自动回收 内容不跨进程保留
+template<typename Key, typename Value>
+class FlashCache
+{
+    using LookupType = typename KeyTraits<Key>::LookupType;
+
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;           // 写入写缓冲的条目
+        uint64_t dropped = 0;           // 写出跟不上或超过区域大小而丢弃的条目
+        uint64_t evicted = 0;           // 区域被覆写时删去的条目
+        uint64_t bytesWritten = 0;      // 写入文件的字节
+    };
+
+    // dir: 缓存文件所在目录(须在SSD上)   fileBytes: 文件大小(至少两个区域)   regionSize: 区域大小 即每次顺序写出的字节数
+    // 目录不存在或不可写时ok()为false 此后放入的条目直接丢弃
+    FlashCache(const std::string& dir, size_t fileBytes, size_t regionSize = 4 << 20)
+        : regionSize(regionSize)
+        , regionCount(static_cast<uint32_t>(std::max<size_t>(2, fileBytes / std::max<size_t>(regionSize, 1))))
+        , fd(-1)
+        , activeRegion(0)
+        , activeUsed(0)
+        , flushRegion(None)
+        , flushBytes(0)
+        , stopFlusher_(false)
+        , regionKeys(regionCount)
+        , generations(regionCount, 0)
+    {
+#ifndef _WIN32
+#ifdef O_TMPFILE
+        fd = ::open(dir.c_str(), O_RDWR | O_TMPFILE | O_EXCL, 0600);
+#endif
+        if(fd < 0)
+        {
+            // 文件系统不支持O_TMPFILE -> 新建唯一文件名的文件 打开后即删除
+            std::string name = dir + "/flashcache.XXXXXX";
+            fd = mkstemp(&name[0]);
+            if(fd >= 0)
+                unlink(name.c_str());
+        }
+        if(fd >= 0 && ftruncate(fd, static_cast<off_t>(regionCount) * static_cast<off_t>(regionSize)) != 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+#endif
+        if(fd < 0)
+            return;
+        activeBuffer.resize(regionSize);
+        flushBuffer.resize(regionSize);
+        flusher = std::thread([this]() { flushLoop(); });
+    }
+
+    ~FlashCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopFlusher_ = true;
+        }
+        flushCond.notify_all();
+        if(flusher.joinable())
+            flusher.join();
+#ifndef _WIN32
+        if(fd >= 0)
+            ::close(fd);
+#endif
+    }
+
+    FlashCache(const FlashCache&) = delete;
+    FlashCache& operator=(const FlashCache&) = delete;
+
+    bool ok() const { return fd >= 0; }
+
+    // 放入(一级缓存驱逐时调用) 只复制进写缓冲 不等待I/O; 已存在则以新条目为准
+    void insert(const Key& key, const Value& value)
+    {
+        if(fd < 0)
+            return;
+        std::string& record = scratch();
+        record.clear();
+        Serializer<Key>::write(record, key);
+        Serializer<Value>::write(record, value);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(record.size() > regionSize)
+        {
+            stats_.dropped++;
+            return;
+        }
+        if(activeUsed + record.size() > regionSize)
+        {
+            // 上一块还没写完 -> 写出跟不上写入速度 丢弃
+            if(flushRegion != None)
+            {
+                stats_.dropped++;
+                return;
+            }
+            activeBuffer.swap(flushBuffer);
+            flushRegion = activeRegion;
+            flushBytes = activeUsed;
+            flushCond.notify_all();
+            activeRegion = (activeRegion + 1) % regionCount;
+            activeUsed = 0;
+            reclaimRegion(activeRegion);
+        }
+        std::memcpy(activeBuffer.data() + activeUsed, record.data(), record.size());
+        auto it = index.find(key);
+        if(it != index.end())
+            index.erase(it);
+        regionKeys[activeRegion].push_back(key);
+        index.emplace(regionKeys[activeRegion].back(),
+                      Location{activeRegion, static_cast<uint32_t>(activeUsed), static_cast<uint32_t>(record.size())});
+        activeUsed += record.size();
+        stats_.inserts++;
+    }
+
+    // 读取 命中后保留
+    bool get(LookupType key, Value& value)
+    {
+        return read(key, value, false);
+    }
+
+    // 读取 命中后从索引中删去(提升回一级缓存时使用)
+    bool take(LookupType key, Value& value)
+    {
+        return read(key, value, true);
+    }
+
+    // 删去key(一级缓存写入新值时使旧值失效) 空间在区域被覆写时回收
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it != index.end())
+            index.erase(it);
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index.size();
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    // 等待已交给后台线程的区域写完
+    void waitFlushed()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        flushedCond.wait(lock, [this]() { return flushRegion == None; });
+    }
+
+private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    struct Location
+    {
+        uint32_t region;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    size_t regionSize;
+    uint32_t regionCount;
+    int fd;
+
+    std::mutex mutex_;
+    std::vector<char> activeBuffer;     // 接收新条目 对应activeRegion
+    uint32_t activeRegion;
+    size_t activeUsed;
+    std::vector<char> flushBuffer;      // 正在写出 对应flushRegion(None表示空闲)
+    uint32_t flushRegion;
+    size_t flushBytes;
+    std::thread flusher;
+    std::condition_variable flushCond;
+    std::condition_variable flushedCond;
+    bool stopFlusher_;
+
+    std::vector<std::deque<Key>> regionKeys;    // 各区域中条目的key(deque追加时地址不变 由索引引用)
+    std::vector<uint64_t> generations;          // 区域代数 每次覆写前加一
+    KeyRefMap<Key, Location> index;
+    Stats stats_;
+
+    // 各线程复用的编码/读取缓冲区
+    static std::string& scratch()
+    {
+        static thread_local std::string buffer;
+        return buffer;
+    }
+
+    // 区域即将被覆写: 删去索引中仍指向它的条目
+    void reclaimRegion(uint32_t region)
+    {
+        for(const Key& key : regionKeys[region])
+        {
+            auto it = index.find(key);
+            if(it != index.end() && it->second.region == region)
+            {
+                index.erase(it);
+                stats_.evicted++;
+            }
+        }
+        regionKeys[region].clear();
+        generations[region]++;
+    }
+
+    // 解码一条记录 key不符(位置已被复用)时返回false
+    static bool decode(const char* data, size_t size, LookupType key, Value& value)
+    {
+        const char* p = data;
+        const char* end = data + size;
+        Key stored;
+        return Serializer<Key>::read(p, end, stored) && stored == key &&
+               Serializer<Value>::read(p, end, value) && p == end;
+    }
+
+    bool read(LookupType key, Value& value, bool remove)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+        {
+            stats_.misses++;
+            return false;
+        }
+        Location location = it->second;
+        if(location.region == activeRegion || location.region == flushRegion)
+        {
+            // 尚未写出 直接从写缓冲读取
+            const std::vector<char>& buffer = location.region == activeRegion ? activeBuffer : flushBuffer;
+            bool success = decode(buffer.data() + location.offset, location.size, key, value);
+            if(remove)
+                index.erase(it);
+            stats_.hits += success;
+            stats_.misses += !success;
+            return success;
+        }
+        uint64_t generation = generations[location.region];
+        if(remove)
+            index.erase(it);
+        lock.unlock();
+
+        std::string& buffer = scratch();
+        buffer.resize(location.size);
+        bool success = false;
+#ifndef _WIN32
+        off_t offset = static_cast<off_t>(location.region) * static_cast<off_t>(regionSize) + location.offset;
+        success = pread(fd, &buffer[0], location.size, offset) == static_cast<ssize_t>(location.size);
+#endif
+        lock.lock();
+        // 读取期间区域被覆写 -> 读到的可能是新数据
+        success = success && generations[location.region] == generation &&
+                  decode(buffer.data(), buffer.size(), key, value);
+        stats_.hits += success;
+        stats_.misses += !success;
+        return success;
+    }
+
+    // 后台写出: 每次把一整块写缓冲顺序写入对应区域
+    void flushLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(true)
+        {
+            flushCond.wait(lock, [this]() { return stopFlusher_ || flushRegion != None; });
+            if(flushRegion == None)
+                return;
+            uint32_t region = flushRegion;
+            size_t bytes = flushBytes;
+            lock.unlock();
+
+            bool success = true;
+#ifndef _WIN32
+            off_t base = static_cast<off_t>(region) * static_cast<off_t>(regionSize);
+            size_t written = 0;
+            while(success && written < bytes)
+            {
+                ssize_t n = pwrite(fd, flushBuffer.data() + written, bytes - written, base + static_cast<off_t>(written));
+                success = n > 0;
+                written += success ? static_cast<size_t>(n) : 0;
+            }
+#ifdef POSIX_FADV_DONTNEED
+            if(success)
+                posix_fadvise(fd, base, static_cast<off_t>(bytes), POSIX_FADV_DONTNEED);
+#endif
+#endif
+            lock.lock();
+            // 写失败的区域不可读 立即从索引中删去
+            if(success)
+                stats_.bytesWritten += bytes;
+            else
+                reclaimRegion(region);
+            flushRegion = None;
+            flushedCond.notify_all();
+        }
+    }
+};
+
+}   // namespace Cache
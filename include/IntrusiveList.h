@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace Cache
+{
+
+// 侵入式链表挂钩: 嵌入结点中 一个结点有几个挂钩就能同时位于几个链表
+template<typename Node>
+struct ListHook
+{
+    Node* prev = nullptr;
+    Node* next = nullptr;
+};
+
+// 侵入式双向链表: 前后指针存放在结点的挂钩中 链表只保存头尾与长度
+// 插入、删除、移动都是O(1)的指针修改 不分配内存 不涉及引用计数
+// 头部为最近(最新)一端 尾部为最久(最老)一端; 结点是否在链表中由调用方记录
+template<typename Node, ListHook<Node> Node::*Hook>
+class IntrusiveList
+{
+public:
+    IntrusiveList() : head(nullptr), tail(nullptr), count(0) {}
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    Node* front() const { return head; }
+    Node* back() const { return tail; }
+
+    // 向尾部方向的下一个结点 到末尾返回nullptr
+    static Node* next(Node* node) { return (node->*Hook).next; }
+    // 向头部方向的上一个结点 到开头返回nullptr
+    static Node* prev(Node* node) { return (node->*Hook).prev; }
+
+    void pushFront(Node* node)
+    {
+        ListHook<Node>& hook = node->*Hook;
+        hook.prev = nullptr;
+        hook.next = head;
+        if(head)
+            (head->*Hook).prev = node;
+        else
+            tail = node;
+        head = node;
+        count++;
+    }
+
+    void pushBack(Node* node)
+    {
+        ListHook<Node>& hook = node->*Hook;
+        hook.next = nullptr;
+        hook.prev = tail;
+        if(tail)
+            (tail->*Hook).next = node;
+        else
+            head = node;
+        tail = node;
+        count++;
+    }
+
+    void remove(Node* node)
+    {
+        ListHook<Node>& hook = node->*Hook;
+        if(hook.prev)
+            (hook.prev->*Hook).next = hook.next;
+        else
+            head = hook.next;
+        if(hook.next)
+            (hook.next->*Hook).prev = hook.prev;
+        else
+            tail = hook.prev;
+        hook.prev = hook.next = nullptr;
+        count--;
+    }
+
+    // 移出尾部结点 空链表返回nullptr
+    Node* popBack()
+    {
+        Node* node = tail;
+        if(node)
+            remove(node);
+        return node;
+    }
+
+    void moveToFront(Node* node)
+    {
+        if(node == head)
+            return;
+        remove(node);
+        pushFront(node);
+    }
+
+    // 清空链表(不访问结点)
+    void clear()
+    {
+        head = tail = nullptr;
+        count = 0;
+    }
+
+private:
+    Node* head;
+    Node* tail;
+    size_t count;
+};
+
+// 结点池: 结点放在deque中 地址在池的生命周期内不变(哈希表可引用结点内的key)
+// 释放的结点进入空闲表供下次分配复用 不逐个new/delete; 复用时由调用方重新设置各字段
+template<typename Node>
+class NodePool
+{
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    Node* allocate()
+    {
+        if(!freeNodes.empty())
+        {
+            Node* node = freeNodes.back();
+            freeNodes.pop_back();
+            return node;
+        }
+        nodes.emplace_back();
+        return &nodes.back();
+    }
+
+    void release(Node* node)
+    {
+        freeNodes.push_back(node);
+    }
+
+    // 正在使用的结点数
+    size_t size() const { return nodes.size() - freeNodes.size(); }
+
+private:
+    std::deque<Node> nodes;
+    std::vector<Node*> freeNodes;
+};
+
+}   // namespace Cache
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Cache
+{
+
+// key类型的查找参数与哈希
+// 默认按const Key&查找; std::string按std::string_view查找 -> 网络缓冲区切片等可直接探测 不构造临时string
+// 两种哈希对相同字符序列的结果相同(标准保证) 分片与哈希表可混用
+template<typename Key>
+struct KeyTraits
+{
+    using LookupType = const Key&;
+    using Hasher = std::hash<Key>;
+};
+
+template<>
+struct KeyTraits<std::string>
+{
+    using LookupType = std::string_view;
+    using Hasher = std::hash<std::string_view>;
+};
+
+// 哈希表的键: 引用结点中保存的key -> 每个条目的key只在结点里存一份
+// 可由查找参数隐式构造 查找时直接传入即可 插入时必须引用结点内(地址稳定)的key
+// 小的可平凡复制类型(int、指针等)直接内联保存 比多一次间接访问更省
+template<typename Key, bool Inline = std::is_trivially_copyable<Key>::value && sizeof(Key) <= sizeof(void*)>
+class KeyRef
+{
+public:
+    KeyRef(const Key& key) : key(&key) {}
+
+    const Key& view() const { return *key; }
+
+    bool operator==(const KeyRef& other) const { return *key == *other.key; }
+
+private:
+    const Key* key;
+};
+
+template<typename Key>
+class KeyRef<Key, true>
+{
+public:
+    KeyRef(const Key& key) : key(key) {}
+
+    const Key& view() const { return key; }
+
+    bool operator==(const KeyRef& other) const { return key == other.key; }
+
+private:
+    Key key;
+};
+
+// string: 保存指向字符数据的string_view 结点中的key与查找用的切片走同一条比较路径
+template<>
+class KeyRef<std::string, false>
+{
+public:
+    KeyRef(const std::string& key) : key(key) {}
+    KeyRef(std::string_view key) : key(key) {}
+
+    std::string_view view() const { return key; }
+
+    bool operator==(const KeyRef& other) const { return key == other.key; }
+
+private:
+    std::string_view key;
+};
+
+template<typename Key>
+struct KeyRefHash
+{
+    size_t operator()(const KeyRef<Key>& ref) const
+    {
+        return typename KeyTraits<Key>::Hasher()(ref.view());
+    }
+};
+
+// key -> Mapped 的哈希表 key存放在Mapped所指的结点中 结点先于表项释放会导致悬垂
+template<typename Key, typename Mapped>
+using KeyRefMap = std::unordered_map<KeyRef<Key>, Mapped, KeyRefHash<Key>>;
+
+}   // namespace Cache
@@ -1,4 +1,9 @@
+#pragma once
+
+#include<algorithm>
+#include<climits>
 #include<cmath>
+#include<functional>
 #include<mutex>
 #include<memory>
 #include<thread>
@@ -6,6 +11,7 @@
 #include<vector>
 
 #include "CachePolicy.h"
+#include "KeyRef.h"
 
 namespace Cache
 {
@@ -30,8 +36,9 @@ private:
 
         Node()
         : freq(1), next(nullptr) {}
-        Node(Key key, Value value)
-        : freq(1), key(key), value(value), next(nullptr) {}
+        template<typename K, typename V>
+        Node(K&& key, V&& value)
+        : freq(1), key(std::forward<K>(key)), value(std::forward<V>(value)), next(nullptr) {}
 
     };
     using NodePtr = std::shared_ptr<Node>;
@@ -90,7 +97,8 @@ class LFUCache : public Policy<Key, Value>
 {
     using Node = typename NodeList<Key, Value>::Node;
     using NodePtr = std::shared_ptr<Node>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = KeyRefMap<Key, NodePtr>;        // key引用结点内的key 只存一份
+    using LookupType = typename Policy<Key, Value>::LookupType;
 private:
     int capacity;           // 最大容量
     int minFreq;            // 最低访问频次
@@ -100,6 +108,11 @@ private:
     std::mutex mutex;       // 互斥锁
     NodeMap nodeMap;        // key -> 缓存结点
     std::unordered_map<int, NodeList<Key, Value>*> freqToFreqList;      // 访问频次 -> 对应列表 
+    // 增量导出: 按频次从低到高逐个列表遍历
+    bool exporting;
+    NodePtr exportCursor;           // 当前列表中下一个待导出的结点 为空表示需切换到下一个列表
+    int exportFreq;                 // 当前导出的列表频次
+    size_t exportRemaining;         // 剩余可导出的条目数
 
 private:
     // 把新结点放入对应的访问频次列表中
@@ -126,6 +139,9 @@ private:
         // 没有则直接返回
         if(freqToFreqList.find(freq) == freqToFreqList.end())
             return;
+        // 导出游标所在结点被移走 -> 游标先前进到其后继 结点移入更高频次的列表后会在之后导出
+        if(node == exportCursor)
+            exportCursor = node->next;
         freqToFreqList[freq]->removeNode(node);
     }
 
@@ -146,12 +162,12 @@ private:
     // 更新最小频率
     void updateMinFreq()
     {
-        minFreq = INT8_MAX;
+        minFreq = INT_MAX;
         // 遍历找出最小的访问频率
         for(const auto& pair : freqToFreqList)
             if(!pair.second && !pair.second->isEmpty())
                 minFreq = std::min(minFreq, pair.first);
-        if(minFreq == INT8_MAX)
+        if(minFreq == INT_MAX)
             minFreq = 1;
     }
 
@@ -183,17 +199,50 @@ private:
             addToFreqList(node);
         }
         updateMinFreq();
+        // 结点移入了更低频次的列表 导出从头重新开始(重复的条目恢复时以后出现的为准)
+        if(exporting)
+            restartExport();
+    }
+
+    void restartExport()
+    {
+        exportCursor = nullptr;
+        exportFreq = 0;
+        exportRemaining = nodeMap.size() + static_cast<size_t>(capacity > 0 ? capacity : 0);
+    }
+
+    // 切换到频次大于exportFreq的最小非空列表 没有则返回false
+    // 每次切换都重新查找: 导出期间结点可能移入新建的或原本为空的列表 预先收集的频次会漏掉它们
+    // 每次O(列表数) 一次导出共O(列表数^2) 与导出的条目数相比很小
+    bool nextExportList()
+    {
+        NodeList<Key, Value>* next = nullptr;
+        int nextFreq = 0;
+        for(const auto& pair : freqToFreqList)
+        {
+            if(pair.first > exportFreq && (!next || pair.first < nextFreq) && pair.second && !pair.second->isEmpty())
+            {
+                next = pair.second;
+                nextFreq = pair.first;
+            }
+        }
+        if(!next)
+            return false;
+        exportFreq = nextFreq;
+        exportCursor = next->getFirstNode();
+        return true;
     }
 
     // key 不在缓存中时放入
-    void putInternel(Key key, Value value)
+    template<typename V>
+    void putInternel(const Key& key, V&& value)
     {
         // 判断缓存容量
         if(nodeMap.size() == capacity)
             kickOut();
 
-        NodePtr node = std::make_shared<Node>(key, value);
-        nodeMap[key] = node;
+        NodePtr node = std::make_shared<Node>(key, std::forward<V>(value));
+        nodeMap.emplace(node->key, node);
         addToFreqList(node);
         addFreqNum();
         minFreq = std::min(minFreq, 1);
@@ -206,13 +255,20 @@ private:
         removeFromFreqList(node);
         nodeMap.erase(node->key);
         decreaseFreqNum(node->freq);
+        this->statsCounter.record(StatsCounter::Eviction);
+        this->notifyEviction(node->key, node->value);
     }
 
     // 从缓存中获取value
     void getInternel(NodePtr node, Value& value)
     {
         value = node->value;
+        increaseFreq(node);
+    }
 
+    // 结点访问频次+1 移入对应的频次列表
+    void increaseFreq(NodePtr node)
+    {
         removeFromFreqList(node);
         node->freq++;
         addToFreqList(node);
@@ -224,49 +280,153 @@ private:
         // 更新访问频次
         addFreqNum();
     }
-    
-public:
-    LFUCache(int capacity, int maxAverageNum=1000000)
-    : capacity(capacity), minFreq(INT8_MAX), maxAverageNum(maxAverageNum)
-    , curAverageNum(0), curTotalNum(0)
-    {}
 
-    ~LFUCache() override = default;
-
-    void put(Key key, Value value) override
+    // 放入或更新 value按左值/右值原样转发 右值只移动不拷贝
+    template<typename V>
+    void putValue(const Key& key, V&& value)
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
         if(capacity == 0)
             return;
+        this->statsCounter.record(StatsCounter::Put);
         std::lock_guard<std::mutex> lock(mutex);
-        if(nodeMap.find(key) != nodeMap.end())
+        auto it = nodeMap.find(key);
+        if(it != nodeMap.end())
         {
-            nodeMap[key]->value = value;
+            it->second->value = std::forward<V>(value);
             // 访问次数+1
-            getInternel(nodeMap[key], value);
+            increaseFreq(it->second);
             return;
         }
-        putInternel(key, value);
+        putInternel(key, std::forward<V>(value));
     }
+    
+public:
+    LFUCache(int capacity, int maxAverageNum=1000000)
+    : capacity(capacity), minFreq(INT_MAX), maxAverageNum(maxAverageNum)
+    , curAverageNum(0), curTotalNum(0)
+    , exporting(false), exportFreq(0), exportRemaining(0)
+    {}
+
+    ~LFUCache() override = default;
 
-    bool get(Key key, Value& value) override
+    void put(const Key& key, const Value& value) override
     {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
         std::lock_guard<std::mutex> lock(mutex);
         auto it = nodeMap.find(key);
         if(it != nodeMap.end())
         {
             getInternel(it->second, value);
+            this->statsCounter.record(StatsCounter::Hit);
             return true;
         }
+        this->statsCounter.record(StatsCounter::Miss);
         return false;
     }
 
-    Value get(Key key) override
+    Value get(LookupType key) override
     {
-        Value value;
+        Value value{};
         get(key, value);
         return value;
     }
 
+    // 放入或更新并把访问频次设为freq 不计入统计 -> 从快照恢复
+    template<typename V>
+    void restore(const Key& key, V&& value, int freq)
+    {
+        if(capacity <= 0)
+            return;
+        freq = std::max(freq, 1);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = nodeMap.find(key);
+        NodePtr node;
+        if(it != nodeMap.end())
+        {
+            node = it->second;
+            removeFromFreqList(node);
+            curTotalNum -= node->freq;
+            node->value = std::forward<V>(value);
+        }
+        else
+        {
+            if(nodeMap.size() >= static_cast<size_t>(capacity))
+                kickOut();
+            node = std::make_shared<Node>(key, std::forward<V>(value));
+            nodeMap.emplace(node->key, node);
+        }
+        node->freq = freq;
+        addToFreqList(node);
+        curTotalNum += freq;
+        // 被覆盖或驱逐的结点可能是最低频次列表中的最后一个
+        if(nodeMap.size() == 1 || freq < minFreq)
+            minFreq = freq;
+        else
+        {
+            auto list = freqToFreqList.find(minFreq);
+            if(list == freqToFreqList.end() || list->second->isEmpty())
+                updateMinFreq();
+        }
+        curAverageNum = curTotalNum / static_cast<int>(nodeMap.size());
+        if(curAverageNum > maxAverageNum)
+            handleOverMaxAverageNum();
+    }
+
+    // 增量导出(不阻塞读写): beginExport后反复调用exportBatch 每批只持锁导出至多maxEntries个条目
+    // 按频次从低到高、同频次从旧到新遍历 fn(key, value, freq)在锁内调用 只应复制数据
+    // 导出期间一直存在的条目至少导出一次; 频次升高的条目可能再导出一次(恢复时以后出现的为准)
+    // 已有导出进行中时返回false
+    bool beginExport()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(exporting)
+            return false;
+        exporting = true;
+        restartExport();
+        return true;
+    }
+
+    // 导出下一批 返回false表示已全部导出(导出随之结束)
+    template<typename Fn>
+    bool exportBatch(size_t maxEntries, Fn&& fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(size_t i=0; i<maxEntries && exporting; i++)
+        {
+            // 游标为空或停在列表尾哨兵(next为空) -> 切换到下一个列表
+            bool more = (exportCursor && exportCursor->next) || nextExportList();
+            if(!more || exportRemaining == 0)
+            {
+                exporting = false;
+                exportCursor = nullptr;
+                break;
+            }
+            fn(exportCursor->key, exportCursor->value, exportCursor->freq);
+            exportCursor = exportCursor->next;
+            exportRemaining--;
+        }
+        return exporting;
+    }
+
+    // 提前结束导出
+    void endExport()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exporting = false;
+        exportCursor = nullptr;
+    }
+
     // 清空缓存 回收资源
     void purge()
     {
@@ -285,10 +445,12 @@ private:
     int sliceNum;       // 分片数
     std::vector<std::unique_ptr<LFUCache<Key, Value>>> LFU_SliceCaches; // 分片缓存
 
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
     // key -> hash值
-    static size_t hash(Key key)
+    static size_t hash(LookupType key)
     {
-        std::hash<Key> hashFunc;
+        typename KeyTraits<Key>::Hasher hashFunc;
         return hashFunc(key);
     }
 
@@ -298,29 +460,68 @@ public:
     : sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
     , capacity(capacity)
     {
-        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum));
-        for(int i=0; i<sliceNum; i++)
+        size_t sliceSize = std::ceil(capacity / static_cast<double>(this->sliceNum));
+        for(int i=0; i<this->sliceNum; i++)
             LFU_SliceCaches.emplace_back(new LFUCache<Key, Value>(sliceSize, maxAverageNum));
     }
 
-    void put(Key key, Value value) override
+    void put(const Key& key, const Value& value) override
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
         size_t position = hash(key) % sliceNum;
         LFU_SliceCaches[position]->put(key, value);
     }
 
-    bool get(Key key, Value& value)
+    void put(const Key& key, Value&& value) override
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        size_t position = hash(key) % sliceNum;
+        LFU_SliceCaches[position]->put(key, std::move(value));
+    }
+
+    bool get(LookupType key, Value& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
         size_t position = hash(key) % sliceNum;
         return LFU_SliceCaches[position]->get(key, value);
     }
 
-    Value get(Key key)
+    Value get(LookupType key)
     {
         Value value{};
         get(key, value);
         return value;
     }
+
+    // 每个分片驱逐时都调用同一监听
+    void setEvictionListener(typename Policy<Key, Value>::EvictionListener listener) override
+    {
+        for(auto& slice : LFU_SliceCaches)
+            slice->setEvictionListener(listener);
+    }
+
+    // 汇总所有分片的统计
+    CacheStats stats() const override
+    {
+        CacheStats total;
+        for(const auto& slice : LFU_SliceCaches)
+            total += slice->stats();
+        return total;
+    }
+
+    // 单个分片的统计
+    CacheStats sliceStats(int index) const
+    {
+        return LFU_SliceCaches[index]->stats();
+    }
+
+    int getSliceNum() const { return sliceNum; }
+
+    // 加载记录到key所在分片
+    void recordLoad(const Key& key, bool success, uint64_t nanos) override
+    {
+        LFU_SliceCaches[hash(key) % sliceNum]->recordLoad(key, success, nanos);
+    }
 };
 
 };
\ No newline at end of file
@@ -0,0 +1,300 @@
+#pragma once
+
+#include<algorithm>
+#include<mutex>
+
+#include "CachePolicy.h"
+#include "IntrusiveList.h"
+#include "KeyRef.h"
+
+namespace Cache
+{
+
+// LIRS: 按重用距离(IRR, 同一key两次访问之间访问过的其他key数)区分冷热 -> 循环/扫描访问下命中率稳定
+// - LIR: 重用距离小的热数据 占容量的大部分 只在重用距离变大时降为HIR
+// - HIR: 常驻的冷数据 占容量的一小部分(hirRatio) 放在队列Q中 淘汰总是从Q的尾部进行
+// - 非常驻HIR: 已被淘汰但仍在栈S中的key(只存key) 再次放入时说明重用距离小于栈底LIR 直接成为LIR
+// 栈S按最近访问排序 栈底总是LIR(剪枝: 弹出栈底的HIR 非常驻的随之删除)
+// 每个条目至多入栈、出栈各一次 剪枝的均摊开销为O(1); 非常驻条目数超过ghostCapacity时删去最早淘汰的
+// 一次循环长度超过容量的扫描中 LRU每次都在命中前淘汰 LIRS则固定保留LIR部分的key
+template<typename Key, typename Value>
+class LIRSCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    enum State : unsigned char
+    {
+        Lir,
+        Hir,
+        NonResident
+    };
+
+    struct Entry
+    {
+        Key key{};
+        Value value{};
+        ListHook<Entry> stackHook;      // 栈S
+        ListHook<Entry> queueHook;      // 常驻HIR队列Q
+        ListHook<Entry> ghostHook;      // 非常驻HIR 按淘汰先后
+        State state = Lir;
+        bool inStack = false;
+    };
+
+    using Stack = IntrusiveList<Entry, &Entry::stackHook>;
+    using Queue = IntrusiveList<Entry, &Entry::queueHook>;
+    using Ghosts = IntrusiveList<Entry, &Entry::ghostHook>;
+
+private:
+    int capacity;                       // 常驻条目数上限(LIR + 常驻HIR)
+    size_t lirCapacity;
+    size_t ghostCapacity;               // 非常驻HIR条目数上限
+    size_t lirCount;
+    NodePool<Entry> pool;
+    KeyRefMap<Key, Entry*> index;       // 所有条目(含非常驻) key引用结点内的key
+    Stack stack;                        // 头部为栈顶(最近访问)
+    Queue queue;                        // 头部为最近进入 尾部最先淘汰
+    Ghosts ghosts;                      // 头部为最近淘汰
+    std::mutex mutex_;
+
+    size_t resident() const { return lirCount + queue.size(); }
+
+    void drop(Entry* entry)
+    {
+        index.erase(entry->key);
+        entry->value = Value{};
+        pool.release(entry);
+    }
+
+    void pushStack(Entry* entry)
+    {
+        stack.pushFront(entry);
+        entry->inStack = true;
+    }
+
+    void removeFromStack(Entry* entry)
+    {
+        stack.remove(entry);
+        entry->inStack = false;
+    }
+
+    // 剪枝: 弹出栈底的HIR直到栈底为LIR 非常驻的已无重用距离信息 直接删除
+    void prune()
+    {
+        while(!stack.empty() && stack.back()->state != Lir)
+        {
+            Entry* entry = stack.back();
+            removeFromStack(entry);
+            if(entry->state == NonResident)
+            {
+                ghosts.remove(entry);
+                drop(entry);
+            }
+        }
+    }
+
+    // LIR超出目标数量时 栈底的LIR降为常驻HIR 放入Q头部
+    void demoteBottomLir()
+    {
+        if(lirCount <= lirCapacity)
+            return;
+        Entry* bottom = stack.back();
+        removeFromStack(bottom);
+        bottom->state = Hir;
+        lirCount--;
+        queue.pushFront(bottom);
+        prune();
+    }
+
+    // 淘汰一个常驻条目: Q尾部的HIR; 仍在栈中则保留key成为非常驻HIR
+    void evict()
+    {
+        Entry* victim = queue.popBack();
+        if(!victim)
+        {
+            // 没有常驻HIR(只在lirCapacity等于容量时出现) -> 淘汰栈底LIR
+            victim = stack.back();
+            removeFromStack(victim);
+            lirCount--;
+            prune();
+        }
+        this->statsCounter.record(StatsCounter::Eviction);
+        this->notifyEviction(victim->key, victim->value);
+        if(!victim->inStack)
+        {
+            drop(victim);
+            return;
+        }
+        victim->state = NonResident;
+        victim->value = Value{};
+        ghosts.pushFront(victim);
+        if(ghosts.size() > ghostCapacity)
+        {
+            Entry* oldest = ghosts.popBack();
+            removeFromStack(oldest);
+            drop(oldest);
+        }
+    }
+
+    // 常驻条目被访问(命中或更新)
+    void access(Entry* entry)
+    {
+        if(entry->state == Lir)
+        {
+            bool wasBottom = entry == stack.back();
+            stack.moveToFront(entry);
+            if(wasBottom)
+                prune();
+            return;
+        }
+        if(entry->inStack || lirCount < lirCapacity)
+        {
+            // 重用距离小于栈底LIR(或删除后LIR未满) -> 升为LIR 超出时栈底LIR降为HIR
+            if(entry->inStack)
+                stack.moveToFront(entry);
+            else
+                pushStack(entry);
+            queue.remove(entry);
+            entry->state = Lir;
+            lirCount++;
+            demoteBottomLir();
+            return;
+        }
+        // 不在栈中 -> 仍为HIR 重新记录访问
+        pushStack(entry);
+        queue.moveToFront(entry);
+    }
+
+    template<typename V>
+    void putValue(const Key& key, V&& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity <= 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it != index.end() && it->second->state != NonResident)
+        {
+            it->second->value = std::forward<V>(value);
+            access(it->second);
+            return;
+        }
+
+        if(it != index.end())
+        {
+            // 非常驻HIR再次放入 -> 先移出非常驻队列与栈 避免腾位置时被删去
+            Entry* entry = it->second;
+            ghosts.remove(entry);
+            removeFromStack(entry);
+            if(resident() >= static_cast<size_t>(capacity))
+                evict();
+            entry->value = std::forward<V>(value);
+            pushStack(entry);
+            entry->state = Lir;
+            lirCount++;
+            demoteBottomLir();
+            return;
+        }
+
+        if(resident() >= static_cast<size_t>(capacity))
+            evict();
+        Entry* entry = pool.allocate();
+        entry->key = key;
+        entry->value = std::forward<V>(value);
+        index.emplace(entry->key, entry);
+        pushStack(entry);
+        // LIR未满(冷启动)时新条目直接成为LIR
+        if(lirCount < lirCapacity)
+        {
+            entry->state = Lir;
+            lirCount++;
+        }
+        else
+        {
+            entry->state = Hir;
+            queue.pushFront(entry);
+        }
+    }
+
+public:
+    // capacity: 缓存条目数   hirRatio: 常驻HIR占容量的比例(至少1条)
+    // ghostCapacity: 非常驻HIR条目数上限 默认为容量的2倍
+    explicit LIRSCache(int capacity, double hirRatio = 0.01, int ghostCapacity = 0)
+        : capacity(capacity)
+        , lirCount(0)
+    {
+        size_t total = static_cast<size_t>(std::max(capacity, 0));
+        size_t hirCapacity = std::max<size_t>(1, static_cast<size_t>(total * hirRatio));
+        lirCapacity = total > hirCapacity ? total - hirCapacity : total;
+        this->ghostCapacity = ghostCapacity > 0 ? ghostCapacity : std::max<size_t>(total * 2, 1);
+    }
+
+    ~LIRSCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end() || it->second->state == NonResident)
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        access(it->second);
+        value = it->second->value;
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定页(同时删去非常驻记录)
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+            return;
+        Entry* entry = it->second;
+        if(entry->state == Lir)
+            lirCount--;
+        else if(entry->state == Hir)
+            queue.remove(entry);
+        else
+            ghosts.remove(entry);
+        if(entry->inStack)
+            removeFromStack(entry);
+        drop(entry);
+        prune();
+    }
+
+    // 常驻条目数
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return resident();
+    }
+
+    size_t lirSize() { std::lock_guard<std::mutex> lock(mutex_); return lirCount; }
+    size_t hirSize() { std::lock_guard<std::mutex> lock(mutex_); return queue.size(); }
+    size_t ghostSize() { std::lock_guard<std::mutex> lock(mutex_); return ghosts.size(); }
+    size_t stackSize() { std::lock_guard<std::mutex> lock(mutex_); return stack.size(); }
+};
+
+}   // namespace Cache
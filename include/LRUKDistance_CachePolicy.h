@@ -0,0 +1,343 @@
+#pragma once
+
+#include<algorithm>
+#include<array>
+#include<cstdint>
+#include<mutex>
+#include<vector>
+
+#include "CachePolicy.h"
+#include "IntrusiveList.h"
+#include "KeyRef.h"
+
+namespace Cache
+{
+
+// LRU-K(论文原版): 按后向K距离淘汰 -> 淘汰倒数第K次访问最早的条目
+// - 每个key记录最近K次(不相关)访问的逻辑时间 hist[0]为最近一次 hist[K-1]为倒数第K次 0表示不足K次(距离无穷大)
+// - 相关访问周期(correlatedPeriod): 距上次访问不超过该周期的访问视为同一次访问的延续 只更新last
+//   周期过后的下一次访问把整段相关访问折叠为一次: 各历史时间一并后移这段周期
+// - 常驻条目放在按(hist[K-1], hist[0])排序的下标堆中 堆顶即后向K距离最大者(距离相同时按LRU) 淘汰O(log n)
+//   correlatedPeriod > 0时 仍在相关周期内的常驻条目不参与淘汰: 它们先按last排在recent队列中 不进堆
+//   淘汰前把周期已过的从队尾移入堆 -> 每个条目每次访问至多进出堆一次 淘汰均摊O(log n) 不分配内存
+// - 被淘汰的条目保留访问历史(只存key) 按最近访问排序 超过historyCapacity时删去最久未访问的 -> 内存有上界
+// 与LRU_KCache(访问K次后才放入的近似)不同 新key总是放入 只是后向K距离为无穷大 会最先被淘汰
+// K为模板参数 历史时间存放在定长数组中 命中也要调整堆 每次操作O(log n)
+template<typename Key, typename Value, int K = 2>
+class LRUKDistanceCache : public Policy<Key, Value>
+{
+    static_assert(K >= 1, "K must be at least 1");
+    using LookupType = typename Policy<Key, Value>::LookupType;
+    static constexpr size_t NotInHeap = static_cast<size_t>(-1);
+
+    struct Entry
+    {
+        Key key{};
+        Value value{};
+        ListHook<Entry> hook;               // 非常驻历史链表 或常驻时的recent队列
+        std::array<uint64_t, K> hist{};     // 最近K次不相关访问的时间
+        uint64_t last = 0;                  // 最近一次访问(含相关访问)的时间
+        size_t heapIndex = NotInHeap;       // 常驻时在堆中的下标
+        bool resident = false;              // 常驻(在堆中或recent队列中)
+        bool awaitingFill = false;          // 上次get未命中 随后的put是它的回填 不再计一次访问
+    };
+
+    using List = IntrusiveList<Entry, &Entry::hook>;
+
+private:
+    size_t capacity;
+    size_t historyCapacity;                 // 非常驻历史条目数上限
+    uint64_t correlatedPeriod;
+    uint64_t clock;                         // 逻辑时间 每次访问加1
+    NodePool<Entry> pool;
+    KeyRefMap<Key, Entry*> index;           // 常驻与非常驻共用 key引用结点内的key
+    std::vector<Entry*> heap;               // 可淘汰的常驻条目 堆顶最先淘汰
+    List recent;                            // 仍在相关周期内的常驻条目 头部为最近访问(按last排序)
+    List history;                           // 非常驻条目 头部为最近访问
+    std::mutex mutex_;
+
+    // a比b更应先淘汰: 倒数第K次访问更早(0即不足K次 最早); 相同时最近一次访问更早
+    static bool before(const Entry* a, const Entry* b)
+    {
+        if(a->hist[K - 1] != b->hist[K - 1])
+            return a->hist[K - 1] < b->hist[K - 1];
+        return a->hist[0] < b->hist[0];
+    }
+
+    void place(size_t i, Entry* entry)
+    {
+        heap[i] = entry;
+        entry->heapIndex = i;
+    }
+
+    void siftUp(size_t i)
+    {
+        Entry* entry = heap[i];
+        while(i > 0)
+        {
+            size_t parent = (i - 1) / 2;
+            if(!before(entry, heap[parent]))
+                break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, entry);
+    }
+
+    void siftDown(size_t i)
+    {
+        Entry* entry = heap[i];
+        size_t n = heap.size();
+        while(true)
+        {
+            size_t child = 2 * i + 1;
+            if(child >= n)
+                break;
+            if(child + 1 < n && before(heap[child + 1], heap[child]))
+                child++;
+            if(!before(heap[child], entry))
+                break;
+            place(i, heap[child]);
+            i = child;
+        }
+        place(i, entry);
+    }
+
+    void heapPush(Entry* entry)
+    {
+        heap.push_back(entry);
+        siftUp(heap.size() - 1);
+    }
+
+    void heapErase(Entry* entry)
+    {
+        size_t i = entry->heapIndex;
+        Entry* moved = heap.back();
+        heap.pop_back();
+        entry->heapIndex = NotInHeap;
+        if(moved == entry)
+            return;
+        place(i, moved);
+        siftUp(i);
+        siftDown(moved->heapIndex);
+    }
+
+    // 记录一次访问: 相关周期内只更新last; 否则折叠此前的相关访问 历史时间后移一位
+    // 返回hist是否改变(常驻条目需要随之调整堆中位置)
+    bool reference(Entry* entry, uint64_t now)
+    {
+        if(entry->hist[0] != 0 && now - entry->last <= correlatedPeriod)
+        {
+            entry->last = now;
+            return false;
+        }
+        uint64_t correlated = entry->hist[0] != 0 ? entry->last - entry->hist[0] : 0;
+        for(int i=K-1; i>0; i--)
+            entry->hist[i] = entry->hist[i - 1] != 0 ? entry->hist[i - 1] + correlated : 0;
+        entry->hist[0] = now;
+        entry->last = now;
+        return true;
+    }
+
+    void drop(Entry* entry)
+    {
+        index.erase(entry->key);
+        entry->value = Value{};
+        pool.release(entry);
+    }
+
+    void trimHistory()
+    {
+        while(history.size() > historyCapacity)
+            drop(history.popBack());
+    }
+
+    // 常驻条目被访问后放回: 在相关周期内的进recent队列头部 否则按新的hist调整堆中位置
+    void touch(Entry* entry, bool histChanged)
+    {
+        if(correlatedPeriod == 0)
+        {
+            if(entry->heapIndex == NotInHeap)
+                heapPush(entry);
+            else if(histChanged)
+                siftDown(entry->heapIndex);
+            return;
+        }
+        if(entry->heapIndex != NotInHeap)
+        {
+            heapErase(entry);
+            recent.pushFront(entry);
+        }
+        else if(entry->resident)
+            recent.moveToFront(entry);
+        else
+            recent.pushFront(entry);
+    }
+
+    // 移出常驻结构(堆或recent队列)
+    void unlinkResident(Entry* entry)
+    {
+        if(entry->heapIndex != NotInHeap)
+            heapErase(entry);
+        else
+            recent.remove(entry);
+        entry->resident = false;
+    }
+
+    // 淘汰后向K距离最大的常驻条目 仍在相关访问周期内的不参与(全部在周期内时淘汰其中最久未访问的)
+    void evict(uint64_t now)
+    {
+        while(!recent.empty() && now - recent.back()->last > correlatedPeriod)
+            heapPush(recent.popBack());
+        Entry* victim = !heap.empty() ? heap.front() : recent.back();
+        unlinkResident(victim);
+
+        this->statsCounter.record(StatsCounter::Eviction);
+        this->notifyEviction(victim->key, victim->value);
+        victim->value = Value{};
+        victim->awaitingFill = false;
+        history.pushFront(victim);
+        trimHistory();
+    }
+
+    template<typename V>
+    void putValue(const Key& key, V&& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity == 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = ++clock;
+        auto it = index.find(key);
+        Entry* entry;
+        if(it != index.end())
+        {
+            entry = it->second;
+            if(entry->resident)
+            {
+                entry->value = std::forward<V>(value);
+                touch(entry, reference(entry, now));
+                return;
+            }
+            // 非常驻 -> 带着访问历史重新放入; get未命中后capacity次操作内的put是它的回填 不再计数
+            history.remove(entry);
+            if(!entry->awaitingFill || now - entry->last > capacity)
+                reference(entry, now);
+            entry->awaitingFill = false;
+        }
+        else
+        {
+            entry = pool.allocate();
+            entry->key = key;
+            entry->hist.fill(0);
+            entry->resident = false;
+            entry->awaitingFill = false;
+            reference(entry, now);
+            index.emplace(entry->key, entry);
+        }
+
+        if(heap.size() + recent.size() >= capacity)
+            evict(now);
+        entry->value = std::forward<V>(value);
+        touch(entry, true);
+        entry->resident = true;
+    }
+
+public:
+    // capacity: 缓存条目数   historyCapacity: 保留访问历史的非常驻条目数 默认与容量相同
+    // correlatedPeriod: 相关访问周期(逻辑时间 即其间的访问次数) 默认0 每次访问都计入历史
+    explicit LRUKDistanceCache(int capacity, int historyCapacity = 0, uint64_t correlatedPeriod = 0)
+        : capacity(static_cast<size_t>(std::max(capacity, 0)))
+        , historyCapacity(historyCapacity > 0 ? historyCapacity : std::max(capacity, 0))
+        , correlatedPeriod(correlatedPeriod)
+        , clock(0)
+    {
+        heap.reserve(this->capacity);
+    }
+
+    ~LRUKDistanceCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    // 命中: 记录访问并调整堆; 非常驻命中: 只记录访问 随后的回填put不再重复计数
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = ++clock;
+        auto it = index.find(key);
+        if(it == index.end())
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        Entry* entry = it->second;
+        if(!entry->resident)
+        {
+            reference(entry, now);
+            entry->awaitingFill = true;
+            history.moveToFront(entry);
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        touch(entry, reference(entry, now));
+        value = entry->value;
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定页(同时删去访问历史)
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+            return;
+        Entry* entry = it->second;
+        if(entry->resident)
+            unlinkResident(entry);
+        else
+            history.remove(entry);
+        drop(entry);
+    }
+
+    // 是否常驻(不记录访问 不计入命中统计)
+    bool contains(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        return it != index.end() && it->second->resident;
+    }
+
+    // 常驻条目数
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return heap.size() + recent.size();
+    }
+
+    // 保留访问历史的非常驻条目数
+    size_t historySize()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return history.size();
+    }
+};
+
+}   // namespace Cache
@@ -1,5 +1,12 @@
+#pragma once
+
+#include<algorithm>
 #include<cmath>
+#include<cstdint>
 #include<thread>
+#include<atomic>
+#include<chrono>
+#include<condition_variable>
 #include<string>
 #include<memory>
 #include<unordered_map>
@@ -7,6 +14,8 @@
 #include<mutex>
 #include<vector>
 #include "CachePolicy.h"
+#include "IntrusiveList.h"
+#include "KeyRef.h"
 
 namespace Cache
 {
@@ -26,11 +35,13 @@ private:
     std::shared_ptr<LRUNode<Key, Value>> next;
 
 public:
-    LRUNode(Key key, Value value) : key(key), value(value) {}
+    template<typename K, typename V>
+    LRUNode(K&& key, V&& value) : key(std::forward<K>(key)), value(std::forward<V>(value)) {}
     // 获取key value 设置value 访问结点
-    Key getKey() const {return key;}
-    Value getValue() const {return value;}
-    void setValue(const Value &value) {this->value = value;}
+    const Key& getKey() const {return key;}
+    const Value& getValue() const {return value;}
+    template<typename V>
+    void setValue(V&& value) {this->value = std::forward<V>(value);}
 
     friend class LRUCache<Key, Value>;
 };
@@ -42,7 +53,8 @@ class LRUCache : public Policy<Key, Value>
 public:
     using NodeType = LRUNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = KeyRefMap<Key, NodePtr>;        // key引用结点内的key 只存一份
+    using LookupType = typename Policy<Key, Value>::LookupType;
 private:
     // 容量  
     int capacity;
@@ -51,6 +63,14 @@ private:
     std::mutex mutex_;
     NodePtr head;
     NodePtr tail;
+    // 幽灵队列: 记录最近被驱逐的key(只存key不存value) 用于评估扩容收益
+    size_t ghostCapacity;
+    std::list<Key> ghostList;
+    KeyRefMap<Key, typename std::list<Key>::iterator> ghostMap;     // key引用ghostList中的元素
+    size_t ghostHits;
+    // 增量导出: 下一个待导出的结点(为空表示未在导出) 及剩余可导出的条目数
+    NodePtr exportCursor;
+    size_t exportRemaining;
     
     // 初始化双向链表和哈希表
     void initializeList()
@@ -77,6 +97,9 @@ private:
     {
         if(!node->prev.expired() && node->next)
         {
+            // 导出游标所在结点被移走 -> 游标先前进到其后继 结点若移到最近访问端会在之后再被导出
+            if(node == exportCursor)
+                exportCursor = node->next;
             node->prev.lock()->next = node->next;
             node->next->prev = node->prev;
             node->next = nullptr;
@@ -89,6 +112,36 @@ private:
         NodePtr least = head->next;
         removeNode(least);
         nodeMap.erase(least->getKey());
+        addToGhost(least->getKey());
+        this->statsCounter.record(StatsCounter::Eviction);
+        this->notifyEviction(least->getKey(), least->getValue());
+    }
+
+    // 被驱逐的key放入幽灵队列头部 超出容量则淘汰最老的记录
+    void addToGhost(const Key& key)
+    {
+        if(ghostCapacity == 0)
+            return;
+        ghostList.push_front(key);
+        ghostMap.emplace(ghostList.front(), ghostList.begin());
+        if(ghostList.size() > ghostCapacity)
+        {
+            ghostMap.erase(ghostList.back());
+            ghostList.pop_back();
+        }
+    }
+
+    // key重新进入缓存时从幽灵队列中删去
+    void removeFromGhost(LookupType key)
+    {
+        if(ghostCapacity == 0)
+            return;
+        auto it = ghostMap.find(key);
+        if(it != ghostMap.end())
+        {
+            ghostList.erase(it->second);
+            ghostMap.erase(it);
+        }
     }
 
     // 将结点移动到最近访问位置
@@ -99,53 +152,83 @@ private:
     }
 
     // 添加新节点(若Cache满则先驱逐最近最久未使用)
-    void addNewNode(const Key& key, const Value& value)
+    template<typename V>
+    void addNewNode(const Key& key, V&& value)
     {   
-        if(nodeMap.size() >= capacity)
+        if(nodeMap.size() >= static_cast<size_t>(capacity))
             removeLeastRecent();
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);
+        removeFromGhost(key);
+        NodePtr newNode = std::make_shared<NodeType>(key, std::forward<V>(value));
         insertNode(newNode);
-        nodeMap[key] = newNode;
+        nodeMap.emplace(newNode->getKey(), newNode);
     }
 
     // 更新某结点的value值
-    void updateExistingNode(NodePtr node, const Value& value)
+    template<typename V>
+    void updateExistingNode(NodePtr node, V&& value)
     {
-        node->setValue(value);
+        node->setValue(std::forward<V>(value));
         moveToMostRecent(node);
     }
 
-public:
-    // 构造函数
-    LRUCache(int capacity)
-    {
-        this->capacity = capacity;
-        initializeList();
-    }
-
-    // 默认析构
-    ~LRUCache() override = default;
-
-    // 放入缓存   
-    void put(Key key, Value value) override
+    // 放入或更新 value按左值/右值原样转发 右值只移动不拷贝
+    template<typename V>
+    void putValue(const Key& key, V&& value)
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        // capacity可能被再平衡线程经setCapacity修改 须在锁内读取
+        std::lock_guard<std::mutex> lock(mutex_);
         if(capacity <= 0)
             return ;
-        std::lock_guard<std::mutex> lock(mutex_);
+        this->statsCounter.record(StatsCounter::Put);
         auto it = nodeMap.find(key);
         if(it != nodeMap.end())
         {
             // 缓存在Cache容器中已经存在    这里对内容进行更新覆写  
-            updateExistingNode(it->second, value);
+            updateExistingNode(it->second, std::forward<V>(value));
             return;
         }
-        addNewNode(key, value);
+        addNewNode(key, std::forward<V>(value));
+    }
+
+public:
+    // 构造函数 -> ghostCapacity为幽灵队列容量 默认为0即不记录
+    LRUCache(int capacity, int ghostCapacity = 0)
+        : ghostCapacity(ghostCapacity > 0 ? ghostCapacity : 0)
+        , ghostHits(0)
+        , exportRemaining(0)
+    {
+        this->capacity = capacity;
+        initializeList();
+    }
+
+    // 逐个断开next指针后再释放 -> 百万级结点的链表按shared_ptr级联析构会递归过深导致栈溢出
+    ~LRUCache() override
+    {
+        NodePtr node = head;
+        while(node)
+        {
+            NodePtr next = std::move(node->next);
+            node = std::move(next);
+        }
+    }
+
+    // 放入缓存   
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
     }
 
     // 从缓存中获取值(直接在传入引用中返回value)
-    bool get(Key key, Value& value) override
+    bool get(LookupType key, Value& value) override
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
         std::lock_guard<std::mutex> lock(mutex_);
         auto it = nodeMap.find(key);
         if(it != nodeMap.end())
@@ -153,13 +236,18 @@ public:
             // 访问该节点
             moveToMostRecent(it->second);
             value = it->second->getValue();
+            this->statsCounter.record(StatsCounter::Hit);
             return true;
         }
+        this->statsCounter.record(StatsCounter::Miss);
+        // 未命中但刚被驱逐 -> 说明容量再大一些即可命中
+        if(ghostCapacity > 0 && ghostMap.find(key) != ghostMap.end())
+            ghostHits++;
         return false;
     }
 
     // 从缓存中获取值(作为返回值返回value)
-    Value get(Key key) override
+    Value get(LookupType key) override
     {
         Value value{};
         get(key, value);
@@ -167,106 +255,462 @@ public:
     }
 
     // 删除指定页
-    void remove(Key key)
+    void remove(LookupType key)
     {
         std::lock_guard<std::mutex> lock(mutex_);
         auto it = nodeMap.find(key);
         if(it != nodeMap.end())
         {
             removeNode(it->second);
-            nodeMap.erase(key);
+            nodeMap.erase(it);
+        }
+    }
+
+    // 是否在缓存中(不更新访问顺序 不计入命中统计)
+    bool contains(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodeMap.find(key) != nodeMap.end();
+    }
+
+    // 若存在则用fn原地修改value并移到最近访问位置 -> 不需要构造Key 不计入命中统计
+    template<typename Fn>
+    bool update(LookupType key, Fn&& fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = nodeMap.find(key);
+        if(it == nodeMap.end())
+            return false;
+        fn(it->second->value);
+        moveToMostRecent(it->second);
+        return true;
+    }
+
+    // 调整容量 缩容时立即驱逐多出的结点
+    void setCapacity(int newCapacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity = newCapacity > 0 ? newCapacity : 0;
+        while(!nodeMap.empty() && nodeMap.size() > static_cast<size_t>(capacity))
+            removeLeastRecent();
+    }
+
+    int getCapacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodeMap.size();
+    }
+
+    // 取出自上次调用以来的幽灵命中次数并清零
+    size_t takeGhostHits()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t hits = ghostHits;
+        ghostHits = 0;
+        return hits;
+    }
+
+    // 放入或更新并移到最近访问位置 不计入统计 -> 从快照恢复时按从旧到新的顺序调用即可还原LRU顺序
+    template<typename V>
+    void restore(const Key& key, V&& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(capacity <= 0)
+            return;
+        auto it = nodeMap.find(key);
+        if(it != nodeMap.end())
+            updateExistingNode(it->second, std::forward<V>(value));
+        else
+            addNewNode(key, std::forward<V>(value));
+    }
+
+    // 增量导出(不阻塞读写): beginExport后反复调用exportBatch 每批只持锁导出至多maxEntries个条目
+    // 从最久未使用向最近使用遍历 fn(key, value)在锁内调用 只应复制数据
+    // 导出期间一直存在的条目至少导出一次; 导出后又被访问的条目移到最近使用端 会再导出一次(按出现顺序恢复即为正确位置)
+    // 已有导出进行中时返回false
+    bool beginExport()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(exportCursor)
+            return false;
+        exportCursor = head->next;
+        // 持续有新条目写入时 导出最多覆盖当前条目数 + 容量 保证结束
+        exportRemaining = nodeMap.size() + static_cast<size_t>(capacity > 0 ? capacity : 0);
+        return true;
+    }
+
+    // 导出下一批 返回false表示已全部导出(导出随之结束)
+    template<typename Fn>
+    bool exportBatch(size_t maxEntries, Fn&& fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(size_t i=0; i<maxEntries; i++)
+        {
+            if(!exportCursor || exportCursor == tail || exportRemaining == 0)
+            {
+                exportCursor = nullptr;
+                return false;
+            }
+            fn(exportCursor->getKey(), exportCursor->getValue());
+            exportCursor = exportCursor->next;
+            exportRemaining--;
         }
+        return true;
+    }
+
+    // 提前结束导出
+    void endExport()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exportCursor = nullptr;
     }
 
 };
 
 // LRU-K: 在LRU基础上增加判断条件，访问次数达到K次后才加入缓存
+// 主缓存与历史记录是同一结点池上的两条侵入式链表 共用一张索引 -> 每次操作一把锁、一次查找
+// - 历史结点记录访问次数 并暂存最近一次放入的value 访问次数达到K时直接晋升 不必再次加载
+// - 历史记录按最近访问排序 超过historyCapacity时删去最久未访问的记录及其暂存的value -> 内存有上界
+// - 主缓存淘汰的条目退回历史记录: 释放value 保留访问次数(再次放入时立即晋升)
+// - get未命中后capacity次操作内的put视为它的回填 与那次get算同一次访问; 回填迟到或始终未到时之后的put照常计数
 template<typename Key, typename Value>
-class LRU_KCache : public LRUCache<Key, Value>
+class LRU_KCache : public Policy<Key, Value>
 {
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    struct Entry
+    {
+        Key key{};
+        Value value{};
+        ListHook<Entry> hook;
+        size_t times = 0;           // 访问次数
+        bool resident = false;      // 在主缓存中
+        bool hasValue = false;      // 历史结点是否暂存了value
+        uint64_t missTick = 0;      // 上次get未命中时的逻辑时间 0表示没有待回填的get
+    };
+
+    using List = IntrusiveList<Entry, &Entry::hook>;
+
 private:
-    int k;                                                  // 进入主缓存的访问次数阈值
-    std::unique_ptr<LRUCache<Key, size_t>> historyList;     // 每个页的访问次数 : 历史队列
-    std::unordered_map<Key, Value> historyValueMap;         // 存储未达到K次的数据
-    std::mutex mutex_;                                      // 保护子类的get/put
+    int capacity;                   // 主缓存容量
+    size_t historyCapacity;         // 历史记录条数上限
+    size_t k;                       // 进入主缓存的访问次数阈值
+    NodePool<Entry> pool;
+    KeyRefMap<Key, Entry*> index;   // 主缓存与历史记录共用 key引用结点内的key
+    List cache;                     // 主缓存 头部为最近访问
+    List history;                   // 历史记录 头部为最近访问
+    uint64_t clock;                 // 逻辑时间 每次get/put加1
+    // 增量导出: 下一个待导出的主缓存条目(从尾部向头部遍历) 及剩余可导出的条目数
+    bool exporting;
+    Entry* exportCursor;
+    size_t exportRemaining;
+    std::mutex mutex_;
 
-public:
-    LRU_KCache(int capacity, int historyCapacity, int k) 
-        : LRUCache<Key, Value>(capacity)
-        , historyList(std::make_unique<LRUCache<Key, size_t>>(historyCapacity))
-        , k(k)
-    {}
+    // 导出游标所在条目离开主缓存中的位置 -> 游标先前进到较新的一侧
+    void unlinkCursor(Entry* entry)
+    {
+        if(entry == exportCursor)
+            exportCursor = List::prev(entry);
+    }
 
-    Value get(Key key)
+    // 移到最近访问端 游标所在条目会在之后再被导出
+    void moveToFront(Entry* entry)
     {
-        // 加锁保证线程安全
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        Value value{};
+        if(entry == cache.front())
+            return;
+        unlinkCursor(entry);
+        cache.moveToFront(entry);
+    }
+
+    // 是否为上次get未命中的回填(同时清除待回填标记)
+    bool takeFill(Entry* entry)
+    {
+        bool fill = entry->missTick != 0 && clock - entry->missTick <= static_cast<uint64_t>(capacity);
+        entry->missTick = 0;
+        return fill;
+    }
+
+    void drop(Entry* entry)
+    {
+        index.erase(entry->key);
+        entry->value = Value{};
+        entry->hasValue = false;
+        pool.release(entry);
+    }
+
+    // 历史记录超出上限 -> 删去最久未访问的记录
+    void trimHistory()
+    {
+        while(history.size() > historyCapacity)
+            drop(history.popBack());
+    }
 
-        // 更新历史记录队列中的访问次数
-        size_t getTimes = historyList->get(key);
-        getTimes++;
-        historyList->put(key, getTimes);
-
-        // 查看是否在主缓存中
-        bool inMainCache = LRUCache<Key, Value>::get(key, value);
-        if(inMainCache)
-            return value;
-        
-        if(getTimes >= k)
+    // 晋升进入主缓存 主缓存满则最久未使用的条目退回历史记录
+    void promote(Entry* entry)
+    {
+        if(cache.size() >= static_cast<size_t>(capacity))
         {
-            auto it = historyValueMap.find(key);
-            if(it != historyValueMap.end())
-            {
-                // 保存历史值 放入主缓存中
-                Value historyValue = it->second;
-                LRUCache<Key, Value>::put(key, historyValue);
+            unlinkCursor(cache.back());
+            Entry* victim = cache.popBack();
+            this->statsCounter.record(StatsCounter::Eviction);
+            this->notifyEviction(victim->key, victim->value);
+            victim->value = Value{};
+            victim->hasValue = false;
+            victim->resident = false;
+            history.pushFront(victim);
+            trimHistory();
+        }
+        entry->resident = true;
+        entry->hasValue = false;
+        entry->missTick = 0;
+        cache.pushFront(entry);
+    }
 
-                // 从历史队列、哈希表中删去
-                historyList->remove(key);
-                historyValueMap.erase(it);
+    // 新的历史记录 访问次数为0 尚未链入历史链表; 传入临时Key时移动进结点 不再复制
+    template<typename K>
+    Entry* newEntry(K&& key)
+    {
+        Entry* entry = pool.allocate();
+        entry->key = std::forward<K>(key);
+        entry->times = 0;
+        entry->resident = false;
+        entry->hasValue = false;
+        entry->missTick = 0;
+        index.emplace(entry->key, entry);
+        return entry;
+    }
 
-                return historyValue;
+    template<typename V>
+    void putValue(const Key& key, V&& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity <= 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+        clock++;
+        auto it = index.find(key);
+        Entry* entry;
+        if(it != index.end())
+        {
+            entry = it->second;
+            if(entry->resident)
+            {
+                entry->value = std::forward<V>(value);
+                moveToFront(entry);
+                return;
             }
+            history.remove(entry);
+        }
+        else
+        {
+            entry = newEntry(key);
+        }
 
+        entry->value = std::forward<V>(value);
+        if(!takeFill(entry))
+            entry->times++;
+        if(entry->times >= k)
+        {
+            promote(entry);
+            return;
         }
-        // 不在主缓存中且访问次数 < k
-        return value;
+        // 未达到K次 -> 暂存value留在历史记录中
+        entry->hasValue = true;
+        history.pushFront(entry);
+        trimHistory();
     }
 
-    void put(Key key, Value value)
+public:
+    LRU_KCache(int capacity, int historyCapacity, int k)
+        : capacity(capacity)
+        , historyCapacity(historyCapacity > 0 ? historyCapacity : 0)
+        , k(k > 1 ? k : 1)
+        , clock(0)
+        , exporting(false)
+        , exportCursor(nullptr)
+        , exportRemaining(0)
+    {}
+
+    ~LRU_KCache() override = default;
+
+    void put(const Key& key, const Value& value) override
     {
-        Value existingValue{};
-        bool inMainCache = LRUCache<Key, Value>::get(key, existingValue);
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    // 主缓存命中直接返回; 否则记录一次访问 达到K次且暂存了value则晋升并返回
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        clock++;
+        auto it = index.find(key);
+        if(it != index.end() && it->second->resident)
+        {
+            moveToFront(it->second);
+            value = it->second->value;
+            this->statsCounter.record(StatsCounter::Hit);
+            return true;
+        }
 
-        // 查看是否在主缓存中已经存在
-        if(inMainCache)
+        Entry* entry;
+        if(it != index.end())
         {
-            // 存在 -> 直接放入
-            LRUCache<Key, Value>::put(key, value);
+            entry = it->second;
+            history.remove(entry);
+        }
+        else
+        {
+            // 未放入过的key也记录访问次数 此时才构造Key
+            entry = newEntry(Key(key));
+        }
+
+        if(++entry->times >= k && entry->hasValue && capacity > 0)
+        {
+            promote(entry);
+            value = entry->value;
+            this->statsCounter.record(StatsCounter::Hit);
+            return true;
+        }
+        entry->missTick = clock;
+        history.pushFront(entry);
+        trimHistory();
+        this->statsCounter.record(StatsCounter::Miss);
+        return false;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定页(同时删去历史记录)
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
             return;
+        Entry* entry = it->second;
+        if(entry->resident)
+        {
+            unlinkCursor(entry);
+            cache.remove(entry);
         }
+        else
+            history.remove(entry);
+        drop(entry);
+    }
+
+    // 是否在主缓存中(不更新访问顺序 不计入命中统计)
+    bool contains(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        return it != index.end() && it->second->resident;
+    }
+
+    // 主缓存条目数
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache.size();
+    }
+
+    // 历史记录条数(其中暂存value的至多historyCapacity个)
+    size_t historySize()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return history.size();
+    }
 
-        // 更新历史记录队列中的访问次数
-        size_t getTimes = historyList->get(key);
-        getTimes++;
-        historyList->put(key, getTimes);
+    // 直接放入主缓存并移到最近访问位置 访问次数记为K 不计入统计 -> 按快照中从旧到新的顺序调用即可还原LRU顺序
+    template<typename V>
+    void restore(const Key& key, V&& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(capacity <= 0)
+            return;
+        auto it = index.find(key);
+        Entry* entry;
+        if(it != index.end())
+        {
+            entry = it->second;
+            entry->value = std::forward<V>(value);
+            if(entry->resident)
+            {
+                moveToFront(entry);
+                return;
+            }
+            history.remove(entry);
+        }
+        else
+        {
+            entry = newEntry(key);
+            entry->value = std::forward<V>(value);
+        }
+        entry->times = std::max(entry->times, k);
+        promote(entry);
+    }
 
-        // 保存键值对
-        historyValueMap[key] = value;
+    // 增量导出主缓存(不含历史记录) 用法与LRUCache相同: 从最久未使用向最近使用遍历 fn(key, value)在锁内调用
+    // 导出后又被访问的条目移到最近使用端 会再导出一次; 已有导出进行中时返回false
+    bool beginExport()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(exporting)
+            return false;
+        exporting = true;
+        exportCursor = cache.back();
+        exportRemaining = cache.size() + static_cast<size_t>(capacity > 0 ? capacity : 0);
+        return true;
+    }
 
-        // 检查是否达到访问阈值 -> 放入主缓存
-        if(getTimes > k)
+    // 导出下一批 返回false表示已全部导出(导出随之结束)
+    template<typename Fn>
+    bool exportBatch(size_t maxEntries, Fn&& fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(size_t i=0; i<maxEntries; i++)
         {
-            historyList->remove(key);
-            historyValueMap.erase(key);
-            LRUCache<Key, Value>::put(key, value);
+            if(!exportCursor || exportRemaining == 0)
+            {
+                exporting = false;
+                exportCursor = nullptr;
+                return false;
+            }
+            fn(exportCursor->key, exportCursor->value);
+            exportCursor = List::prev(exportCursor);
+            exportRemaining--;
         }
+        return true;
+    }
+
+    // 提前结束导出
+    void endExport()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exporting = false;
+        exportCursor = nullptr;
     }
 };
 
 // LRU-Slice: 分片LRU缓存 把缓存分片供多个线程取用 增强并发性能
+// 可选后台再平衡: 按各分片的幽灵命中次数在分片间移动容量 总容量保持不变
 template<typename Key, typename Value>
 class LRU_HashCache : public Policy<Key, Value>
 {
@@ -275,54 +719,187 @@ private:
     int sliceNum;                                                           //分片数
     std::vector<std::unique_ptr<LRUCache<Key, Value>>> LRU_SliceCaches;      //切片缓存
 
+    std::mutex rebalanceMutex;                                              // 保护再平衡过程
+    std::mutex rebalancerMutex;                                             // 保护后台线程启停
+    std::condition_variable rebalancerCond;
+    std::thread rebalancer;                                                 // 后台再平衡线程
+    bool stopRebalancer_;
+
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
     // 把key转换成对应的哈希值
-    static size_t Hash(Key key)
+    static size_t Hash(LookupType key)
     {
-        std::hash<Key> hashFunc;
+        typename KeyTraits<Key>::Hasher hashFunc;
         return hashFunc(key);
     }
 
+    // 按总容量精确分配各分片容量(前 capacity % sliceNum 个分片多分1) 幽灵队列与分片同大小
+    void initializeSlices()
+    {
+        size_t baseSize = capacity / sliceNum;
+        for(int i=0; i<sliceNum; i++)
+        {
+            size_t sliceSize = baseSize + (static_cast<size_t>(i) < capacity % sliceNum ? 1 : 0);
+            size_t ghostSize = std::max<size_t>(std::ceil(capacity / static_cast<double>(sliceNum)), 1);
+            LRU_SliceCaches.emplace_back(new LRUCache<Key, Value>(sliceSize, ghostSize));
+        }
+    }
+
 public:
     // 构造函数 -> 如果分片数未指定/不合法则使用CPU核心数
     LRU_HashCache(size_t capacity, int sliceNum)
         : capacity(capacity)
-        , sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
+        , sliceNum(sliceNum > 0 ? sliceNum : std::max(1u, std::thread::hardware_concurrency()))
+        , stopRebalancer_(false)
     {
-        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum)); // 向上取整计算每个分片容量
-        for(int i=0; i<sliceNum; i++)
-            LRU_SliceCaches.emplace_back(new LRUCache<Key, Value>(sliceSize));
+        initializeSlices();
     }
 
     LRU_HashCache(size_t capacity)
-        : capacity(capacity)
-        , sliceNum(std::thread::hardware_concurrency())
+        : LRU_HashCache(capacity, 0)
+    {}
+
+    ~LRU_HashCache() override
     {
-        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum)); // 向上取整计算每个分片容量
-        for(int i=0; i<sliceNum; i++)
-            LRU_SliceCaches.emplace_back(new LRUCache<Key, Value>(sliceSize));
+        stopRebalance();
     }
 
-    void put(Key key, Value value) override
+    void put(const Key& key, const Value& value) override
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
         // 计算出对应的分片位置并放入值
         size_t position = Hash(key) % sliceNum;
         LRU_SliceCaches[position]->put(key, value);
     }
 
-    bool get(Key key, Value& value) override
+    void put(const Key& key, Value&& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        size_t position = Hash(key) % sliceNum;
+        LRU_SliceCaches[position]->put(key, std::move(value));
+    }
+
+    bool get(LookupType key, Value& value) override
     {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
         // 计算出分片位置并获取值
         size_t position = Hash(key) % sliceNum;
         return LRU_SliceCaches[position]->get(key, value);
     }
 
-    Value get(Key key) override
+    Value get(LookupType key) override
     {
         // 调用get(key, & value)方法
         Value value{};
         get(key, value);
         return value;
     }
+
+    // 执行一轮再平衡: 从幽灵命中最少的分片移出容量给幽灵命中最多的分片
+    // 幽灵命中 = 刚被本分片驱逐又被访问 反映了该分片扩容后能多得到的命中
+    void rebalance()
+    {
+        std::lock_guard<std::mutex> lock(rebalanceMutex);
+        if(sliceNum < 2)
+            return;
+
+        std::vector<size_t> ghostHits(sliceNum);
+        for(int i=0; i<sliceNum; i++)
+            ghostHits[i] = LRU_SliceCaches[i]->takeGhostHits();
+
+        // 接收方: 幽灵命中最多的分片     捐出方: 幽灵命中最少且容量大于1的分片
+        int receiver = 0;
+        for(int i=1; i<sliceNum; i++)
+            if(ghostHits[i] > ghostHits[receiver])
+                receiver = i;
+
+        int donor = -1;
+        for(int i=0; i<sliceNum; i++)
+        {
+            if(i == receiver || LRU_SliceCaches[i]->getCapacity() <= 1)
+                continue;
+            if(donor < 0 || ghostHits[i] < ghostHits[donor])
+                donor = i;
+        }
+        if(donor < 0 || ghostHits[receiver] <= ghostHits[donor])
+            return;
+
+        // 每轮移动约 1/8 的平均分片容量 至少为1
+        int step = std::max<int>(1, capacity / sliceNum / 8);
+        int donorCapacity = LRU_SliceCaches[donor]->getCapacity();
+        step = std::min(step, donorCapacity - 1);
+
+        LRU_SliceCaches[donor]->setCapacity(donorCapacity - step);
+        LRU_SliceCaches[receiver]->setCapacity(LRU_SliceCaches[receiver]->getCapacity() + step);
+    }
+
+    // 启动后台再平衡线程 每隔interval执行一次rebalance
+    void startRebalance(std::chrono::milliseconds interval)
+    {
+        std::lock_guard<std::mutex> lock(rebalancerMutex);
+        if(rebalancer.joinable())
+            return;
+        stopRebalancer_ = false;
+        rebalancer = std::thread([this, interval]()
+        {
+            std::unique_lock<std::mutex> lock(rebalancerMutex);
+            while(!rebalancerCond.wait_for(lock, interval, [this]() { return stopRebalancer_; }))
+            {
+                lock.unlock();
+                rebalance();
+                lock.lock();
+            }
+        });
+    }
+
+    // 停止后台再平衡线程
+    void stopRebalance()
+    {
+        {
+            std::lock_guard<std::mutex> lock(rebalancerMutex);
+            stopRebalancer_ = true;
+        }
+        rebalancerCond.notify_all();
+        if(rebalancer.joinable())
+            rebalancer.join();
+    }
+
+    // 获取某个分片当前容量
+    int getSliceCapacity(int index)
+    {
+        return LRU_SliceCaches[index]->getCapacity();
+    }
+
+    // 每个分片驱逐时都调用同一监听
+    void setEvictionListener(typename Policy<Key, Value>::EvictionListener listener) override
+    {
+        for(auto& slice : LRU_SliceCaches)
+            slice->setEvictionListener(listener);
+    }
+
+    // 汇总所有分片的统计
+    CacheStats stats() const override
+    {
+        CacheStats total;
+        for(const auto& slice : LRU_SliceCaches)
+            total += slice->stats();
+        return total;
+    }
+
+    // 单个分片的统计
+    CacheStats sliceStats(int index) const
+    {
+        return LRU_SliceCaches[index]->stats();
+    }
+
+    int getSliceNum() const { return sliceNum; }
+
+    // 加载记录到key所在分片
+    void recordLoad(const Key& key, bool success, uint64_t nanos) override
+    {
+        LRU_SliceCaches[Hash(key) % sliceNum]->recordLoad(key, success, nanos);
+    }
 };
 
 }   // namespace Cache
\ No newline at end of file
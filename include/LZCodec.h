@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace Cache
+{
+namespace LZ
+{
+
+// 单遍贪心LZ77压缩 输出为LZ4块格式(不含帧头) 可与lz4的LZ4_decompress_safe互通
+// - 序列: token(高4位字面量长度 低4位匹配长度-4) [长度扩展字节] 字面量 [偏移 2字节小端] [长度扩展字节]
+// - 4字节序列哈希到4096项的位置表 查表命中即贪心扩展 连续未命中时逐渐加大步长跳过不可压缩段
+// - 按格式约定: 最后5字节总是字面量 最后一个匹配至少在块尾12字节之前开始
+// 压缩与解压都不分配内存 可在多个线程中同时调用
+
+constexpr size_t MinMatch = 4;
+constexpr size_t LastLiterals = 5;
+constexpr size_t MatchFindLimit = 12;
+constexpr size_t MaxOffset = 65535;
+constexpr unsigned HashLog = 12;
+
+// size字节的输入压缩后的最大长度(全部为字面量的情况)
+inline size_t maxCompressedSize(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+namespace detail
+{
+inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+// 长度超过15的部分写成若干255与一个余数字节
+inline uint8_t* writeLength(uint8_t* op, size_t length)
+{
+    while(length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+inline uint8_t* writeLiterals(uint8_t* op, uint8_t* token, const uint8_t* literals, size_t length)
+{
+    if(length >= 15)
+    {
+        *token = 15 << 4;
+        op = writeLength(op, length - 15);
+    }
+    else
+        *token = static_cast<uint8_t>(length << 4);
+    std::memcpy(op, literals, length);
+    return op + length;
+}
+
+// 读取扩展长度 越界返回false
+inline bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+{
+    uint8_t byte;
+    do
+    {
+        if(ip >= end)
+            return false;
+        byte = *ip++;
+        length += byte;
+    } while(byte == 255);
+    return true;
+}
+}   // namespace detail
+
+// 压缩src[0, size) 写入dst 返回压缩后长度
+// dst至少需要maxCompressedSize(size)字节
+inline size_t compress(const char* src, size_t size, char* dst)
+{
+    const uint8_t* const in = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* const end = in + size;
+    const uint8_t* anchor = in;
+    uint8_t* op = reinterpret_cast<uint8_t*>(dst);
+
+    if(size > MatchFindLimit)
+    {
+        uint32_t table[1u << HashLog] = {};     // 哈希 -> 该序列上次出现的位置
+        const uint8_t* const matchLimit = end - LastLiterals;
+        const uint8_t* ip = in + 1;
+        size_t misses = 0;
+
+        while(ip + MatchFindLimit <= end)
+        {
+            uint32_t sequence = detail::read32(ip);
+            uint32_t h = detail::hash(sequence);
+            const uint8_t* ref = in + table[h];
+            table[h] = static_cast<uint32_t>(ip - in);
+            if(ref >= ip || static_cast<size_t>(ip - ref) > MaxOffset || detail::read32(ref) != sequence)
+            {
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            // 向前扩展到上一序列的末尾
+            while(ip > anchor && ref > in && ip[-1] == ref[-1])
+            {
+                ip--;
+                ref--;
+            }
+            size_t length = MinMatch;
+            while(ip + length < matchLimit && ip[length] == ref[length])
+                length++;
+
+            uint8_t* token = op++;
+            op = detail::writeLiterals(op, token, anchor, static_cast<size_t>(ip - anchor));
+            uint16_t offset = static_cast<uint16_t>(ip - ref);
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            size_t extra = length - MinMatch;
+            if(extra >= 15)
+            {
+                *token |= 15;
+                op = detail::writeLength(op, extra - 15);
+            }
+            else
+                *token |= static_cast<uint8_t>(extra);
+
+            ip += length;
+            anchor = ip;
+            // 匹配末尾附近的位置也记入表中 提高下一次命中率
+            if(ip + MatchFindLimit <= end)
+                table[detail::hash(detail::read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - in);
+        }
+    }
+
+    // 剩余部分作为最后一个序列的字面量
+    uint8_t* token = op++;
+    op = detail::writeLiterals(op, token, anchor, static_cast<size_t>(end - anchor));
+    return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(dst));
+}
+
+// 解压src[0, size) 到dst 原始长度须为rawSize 输入损坏或长度不符时返回false 不会越界读写
+inline bool decompress(const char* src, size_t size, char* dst, size_t rawSize)
+{
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* const inEnd = ip + size;
+    uint8_t* const out = reinterpret_cast<uint8_t*>(dst);
+    uint8_t* op = out;
+    uint8_t* const outEnd = out + rawSize;
+
+    while(ip < inEnd)
+    {
+        uint8_t token = *ip++;
+        size_t literals = token >> 4;
+        if(literals == 15 && !detail::readLength(ip, inEnd, literals))
+            return false;
+        if(literals > static_cast<size_t>(inEnd - ip) || literals > static_cast<size_t>(outEnd - op))
+            return false;
+        std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+        if(ip == inEnd)
+            return op == outEnd;        // 最后一个序列只有字面量
+
+        if(inEnd - ip < 2)
+            return false;
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if(offset == 0 || offset > static_cast<size_t>(op - out))
+            return false;
+        size_t length = token & 15;
+        if(length == 15 && !detail::readLength(ip, inEnd, length))
+            return false;
+        length += MinMatch;
+        if(length > static_cast<size_t>(outEnd - op))
+            return false;
+
+        const uint8_t* match = op - offset;
+        if(offset >= length)
+            std::memcpy(op, match, length);
+        else
+        {
+            // 与输出重叠(周期为offset的重复模式): 每次从match起复制已写出的整周期 复制量逐次翻倍
+            size_t copied = 0;
+            while(copied < length)
+            {
+                size_t chunk = std::min(offset + copied, length - copied);
+                std::memcpy(op + copied, match, chunk);
+                copied += chunk;
+            }
+        }
+        op += length;
+    }
+    return false;
+}
+
+}   // namespace LZ
+}   // namespace Cache
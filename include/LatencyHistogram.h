@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CACHE_HAS_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#include "CacheStats.h"
+
+namespace Cache
+{
+
+// 低开销时钟: x86下直接读时间戳计数器(rdtsc) 其他平台退化为steady_clock
+class CycleClock
+{
+public:
+    static uint64_t now()
+    {
+#ifdef CACHE_HAS_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // 每个tick对应的纳秒数 -> 首次调用时与steady_clock对比校准一次
+    static double nanosPerTick()
+    {
+        static const double ratio = calibrate();
+        return ratio;
+    }
+
+    static uint64_t toNanos(uint64_t ticks)
+    {
+        return static_cast<uint64_t>(ticks * nanosPerTick());
+    }
+
+private:
+    static double calibrate()
+    {
+#ifdef CACHE_HAS_RDTSC
+        using SteadyClock = std::chrono::steady_clock;
+        auto startTime = SteadyClock::now();
+        uint64_t startTick = now();
+        while(SteadyClock::now() - startTime < std::chrono::milliseconds(2))
+            ;
+        uint64_t ticks = now() - startTick;
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now() - startTime).count();
+        return ticks == 0 ? 1.0 : static_cast<double>(nanos) / ticks;
+#else
+        return 1.0;
+#endif
+    }
+};
+
+// 直方图快照 -> 合并后的桶计数 用于计算分位数
+class HistogramSnapshot
+{
+public:
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    // p取值[0, 100] 返回所在桶的上界(纳秒) 相对误差不超过 1/SubBucketCount
+    uint64_t percentile(double p) const;
+
+    double mean() const { return count == 0 ? 0.0 : static_cast<double>(sum) / count; }
+
+    HistogramSnapshot& operator+=(const HistogramSnapshot& other)
+    {
+        if(counts.size() < other.counts.size())
+            counts.resize(other.counts.size(), 0);
+        for(size_t i=0; i<other.counts.size(); i++)
+            counts[i] += other.counts[i];
+        count += other.count;
+        sum += other.sum;
+        max = std::max(max, other.max);
+        return *this;
+    }
+};
+
+// HDR风格对数分桶直方图: 每个2的幂区间再线性细分为SubBucketCount个子桶
+// 记录值为纳秒 可表示到约68秒 相对精度约3%
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 5;
+    static constexpr uint64_t SubBucketCount = 1ull << SubBucketBits;
+    static constexpr int MaxValueBits = 36;
+    static constexpr size_t BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+
+    LatencyHistogram()
+    {
+        for(auto& bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    // 值 -> 桶下标
+    static size_t bucketIndex(uint64_t value)
+    {
+        value = std::min<uint64_t>(value, (1ull << MaxValueBits) - 1);
+        if(value < 2 * SubBucketCount)
+            return static_cast<size_t>(value);
+        int msb = 63 - countLeadingZeros(value);
+        int shift = msb - SubBucketBits;
+        return static_cast<size_t>((shift + 1) * SubBucketCount + ((value >> shift) - SubBucketCount));
+    }
+
+    // 桶下标 -> 桶内最大值
+    static uint64_t bucketUpperBound(size_t index)
+    {
+        if(index < 2 * SubBucketCount)
+            return index;
+        int shift = static_cast<int>(index / SubBucketCount) - 1;
+        uint64_t sub = index % SubBucketCount + SubBucketCount;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    // 单线程写入为主 使用relaxed原子保证多个线程共用一个槽位时仍然正确
+    void record(uint64_t nanos)
+    {
+        buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t curMax = max.load(std::memory_order_relaxed);
+        while(nanos > curMax && !max.compare_exchange_weak(curMax, nanos, std::memory_order_relaxed))
+            ;
+    }
+
+    void mergeInto(HistogramSnapshot& snapshot) const
+    {
+        if(snapshot.counts.size() < BucketCount)
+            snapshot.counts.resize(BucketCount, 0);
+        for(size_t i=0; i<BucketCount; i++)
+            snapshot.counts[i] += buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += count.load(std::memory_order_relaxed);
+        snapshot.sum += sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, max.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> buckets;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+
+    static int countLeadingZeros(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int n = 0;
+        for(uint64_t bit = 1ull << 63; bit && !(value & bit); bit >>= 1)
+            n++;
+        return n;
+#endif
+    }
+};
+
+inline uint64_t HistogramSnapshot::percentile(double p) const
+{
+    if(count == 0)
+        return 0;
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * count);
+    target = std::max<uint64_t>(1, std::min(target, count));
+    uint64_t seen = 0;
+    for(size_t i=0; i<counts.size(); i++)
+    {
+        seen += counts[i];
+        if(seen >= target)
+            return std::min(LatencyHistogram::bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+// 按操作类型记录延迟: 每个线程写入自己槽位的直方图 读取时合并
+// 支持采样(每2^sampleShift次操作记录一次)以进一步降低开销
+class LatencyRecorder
+{
+public:
+    enum Op
+    {
+        Get,
+        Put,
+        Load,
+        OpCount
+    };
+
+    explicit LatencyRecorder(unsigned sampleShift = 0)
+        : sampleMask((1u << std::min(sampleShift, 16u)) - 1)
+    {
+        for(auto& slot : slots)
+            slot.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~LatencyRecorder()
+    {
+        for(auto& slot : slots)
+            delete slot.load(std::memory_order_relaxed);
+    }
+
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+    // 当前线程本次操作是否需要采样
+    bool shouldSample() const
+    {
+        if(sampleMask == 0)
+            return true;
+        thread_local unsigned tick = 0;
+        return (tick++ & sampleMask) == 0;
+    }
+
+    void record(Op op, uint64_t nanos)
+    {
+        threadHistograms()[op].record(nanos);
+    }
+
+    // 合并所有线程的直方图
+    HistogramSnapshot snapshot(Op op) const
+    {
+        HistogramSnapshot result;
+        for(const auto& slot : slots)
+        {
+            Histograms* histograms = slot.load(std::memory_order_acquire);
+            if(histograms)
+                (*histograms)[op].mergeInto(result);
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t SlotNum = 64;
+    using Histograms = std::array<LatencyHistogram, OpCount>;
+
+    unsigned sampleMask;
+    std::array<std::atomic<Histograms*>, SlotNum> slots;
+
+    // 按线程槽位懒分配直方图 线程数超过槽位数时共用(原子计数仍然正确)
+    Histograms& threadHistograms()
+    {
+        std::atomic<Histograms*>& slot = slots[detail::threadSlot() % SlotNum];
+        Histograms* histograms = slot.load(std::memory_order_acquire);
+        if(histograms)
+            return *histograms;
+
+        Histograms* created = new Histograms();
+        if(slot.compare_exchange_strong(histograms, created, std::memory_order_acq_rel))
+            return *created;
+        delete created;
+        return *histograms;
+    }
+};
+
+// 作用域计时: 构造时取时间戳 析构时记录
+// 同一线程内嵌套的计时(如分片缓存调用分片 LRU-K调用内部LRU)只记录最外层
+class LatencyScope
+{
+public:
+    LatencyScope(LatencyRecorder* recorder, LatencyRecorder::Op op)
+        : recorder(nullptr)
+        , op(op)
+        , start(0)
+    {
+        if(!recorder || activeScope() || !recorder->shouldSample())
+            return;
+        this->recorder = recorder;
+        activeScope() = true;
+        start = CycleClock::now();
+    }
+
+    ~LatencyScope()
+    {
+        if(!recorder)
+            return;
+        recorder->record(op, CycleClock::toNanos(CycleClock::now() - start));
+        activeScope() = false;
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    LatencyRecorder* recorder;
+    LatencyRecorder::Op op;
+    uint64_t start;
+
+    static bool& activeScope()
+    {
+        thread_local bool active = false;
+        return active;
+    }
+};
+
+}   // namespace Cache
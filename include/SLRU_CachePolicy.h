@@ -0,0 +1,165 @@
+#pragma once
+
+#include<algorithm>
+#include<mutex>
+
+#include "CachePolicy.h"
+#include "IntrusiveList.h"
+#include "KeyRef.h"
+
+namespace Cache
+{
+
+// 分段LRU(SLRU): 缓存分为试用段(probation)与保护段(protected)两段LRU
+// - 新条目进入试用段 在试用段中再次被访问才升入保护段
+// - 保护段超出容量时 其最久未使用的条目降回试用段(而不是直接淘汰)
+// - 淘汰总是从试用段尾部进行 只访问一次的key不会挤掉保护段中的热数据
+// 两段的结点共用一个结点池与一张索引 每次操作一把锁、一次查找
+template<typename Key, typename Value>
+class SLRUCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    struct Entry
+    {
+        Key key{};
+        Value value{};
+        ListHook<Entry> hook;
+        bool isProtected = false;
+    };
+
+    using List = IntrusiveList<Entry, &Entry::hook>;
+
+private:
+    int capacity;
+    size_t protectedCapacity;
+    NodePool<Entry> pool;
+    KeyRefMap<Key, Entry*> index;       // key引用结点内的key
+    List probation;                     // 头部为最近访问
+    List protect;
+    std::mutex mutex_;
+
+    // 访问已有条目: 试用段中的升入保护段 保护段满则把其最久未使用的条目降回试用段
+    void access(Entry* entry)
+    {
+        if(entry->isProtected)
+        {
+            protect.moveToFront(entry);
+            return;
+        }
+        probation.remove(entry);
+        entry->isProtected = true;
+        protect.pushFront(entry);
+        if(protect.size() > protectedCapacity)
+        {
+            Entry* demoted = protect.popBack();
+            demoted->isProtected = false;
+            probation.pushFront(demoted);
+        }
+    }
+
+    // 淘汰试用段最久未使用的条目 试用段为空(保护段占满容量)时淘汰保护段的
+    void evict()
+    {
+        Entry* victim = probation.popBack();
+        if(!victim)
+            victim = protect.popBack();
+        this->statsCounter.record(StatsCounter::Eviction);
+        this->notifyEviction(victim->key, victim->value);
+        index.erase(victim->key);
+        victim->value = Value{};
+        pool.release(victim);
+    }
+
+    template<typename V>
+    void putValue(const Key& key, V&& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity <= 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it != index.end())
+        {
+            it->second->value = std::forward<V>(value);
+            access(it->second);
+            return;
+        }
+        if(index.size() >= static_cast<size_t>(capacity))
+            evict();
+        Entry* entry = pool.allocate();
+        entry->key = key;
+        entry->value = std::forward<V>(value);
+        entry->isProtected = false;
+        probation.pushFront(entry);
+        index.emplace(entry->key, entry);
+    }
+
+public:
+    // capacity: 缓存条目数   protectedRatio: 保护段占容量的比例 默认80%
+    explicit SLRUCache(int capacity, double protectedRatio = 0.8)
+        : capacity(capacity)
+        , protectedCapacity(static_cast<size_t>(std::max(capacity, 0) * std::min(std::max(protectedRatio, 0.0), 1.0)))
+    {}
+
+    ~SLRUCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        access(it->second);
+        value = it->second->value;
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定页
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+            return;
+        Entry* entry = it->second;
+        (entry->isProtected ? protect : probation).remove(entry);
+        index.erase(it);
+        entry->value = Value{};
+        pool.release(entry);
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index.size();
+    }
+
+    size_t probationSize() { std::lock_guard<std::mutex> lock(mutex_); return probation.size(); }
+    size_t protectedSize() { std::lock_guard<std::mutex> lock(mutex_); return protect.size(); }
+};
+
+}   // namespace Cache
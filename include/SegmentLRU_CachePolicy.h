@@ -0,0 +1,226 @@
+#pragma once
+
+#include<chrono>
+#include<condition_variable>
+#include<list>
+#include<mutex>
+#include<string>
+#include<thread>
+#include<type_traits>
+
+#include "CachePolicy.h"
+#include "KeyRef.h"
+#include "SegmentStore.h"
+
+namespace Cache
+{
+
+// 段存储LRU: 淘汰顺序为LRU value字节存放在SegmentStore的大段中 按内存预算而非条目数限制大小
+// 大量变长字符串持续淘汰时不在全局分配器中产生碎片 常驻内存不超过预算:
+// - 放入前若存活字节将超过上限 先按LRU淘汰 被淘汰的旧记录集中在早期写入的段中 段空后整段释放
+// - 写入段用尽时清理活跃字节最少的段腾出空间; startCompaction可开启后台清理 提前合并稀疏段
+// 超过单段大小的value不缓存(同时删去该key的旧值)
+template<typename Key, typename Value>
+class SegmentLRUCache : public Policy<Key, Value>
+{
+    static_assert(std::is_same<Value, std::string>::value, "SegmentLRUCache的value须为std::string");
+
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    struct Entry
+    {
+        Key key;
+        SegmentStore::Location location;
+    };
+    using EntryList = std::list<Entry>;       // 头部为最近最久未使用 尾部为最近使用
+
+private:
+    int capacity;
+    double fillRatio;
+    SegmentStore store;
+    EntryList entries;
+    KeyRefMap<Key, typename EntryList::iterator> index;     // key引用链表结点中的key
+    std::mutex mutex_;
+
+    std::thread compactor;                                  // 后台清理线程
+    std::mutex compactorMutex;
+    std::condition_variable compactorCond;
+    bool stopCompactor_;
+
+    void removeEntry(typename EntryList::iterator it)
+    {
+        store.release(it->location);
+        index.erase(it->key);
+        entries.erase(it);
+    }
+
+    void removeLeastRecent()
+    {
+        // 有监听时先从段中复制出value 记录随后即被释放
+        if(this->evictionListener)
+        {
+            std::string_view bytes = store.read(entries.front().location);
+            this->notifyEviction(entries.front().key, Value(bytes.data(), bytes.size()));
+        }
+        removeEntry(entries.begin());
+        this->statsCounter.record(StatsCounter::Eviction);
+    }
+
+    void putValue(const Key& key, const Value& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity <= 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // 已存在 -> 删去旧记录后按新记录写入(日志结构不原地覆写)
+        // 新value超过单段大小时不缓存 旧值同样删去 不能再读到过期数据
+        auto it = index.find(key);
+        if(it != index.end())
+            removeEntry(it->second);
+        if(value.size() > store.maxValueSize())
+            return;
+
+        while(!entries.empty() && (entries.size() >= static_cast<size_t>(capacity) ||
+              store.liveBytes() + SegmentStore::recordSize(value.size()) > store.liveLimit(fillRatio)))
+            removeLeastRecent();
+
+        entries.push_back(Entry{key, SegmentStore::Location{}});
+        Entry& entry = entries.back();
+        // 清理也腾不出空间时继续淘汰 新条目在尾部不会被淘汰
+        while(!store.append(value.data(), value.size(), &entry, entry.location))
+        {
+            if(entries.size() == 1)
+            {
+                entries.pop_back();
+                return;
+            }
+            removeLeastRecent();
+        }
+        index.emplace(entry.key, std::prev(entries.end()));
+    }
+
+public:
+    // capacity: 条目数上限   memoryBudget: value存储的内存预算(字节)   segmentSize: 段大小
+    // fillRatio: 存活字节占可用空间的上限 余量越大清理搬动越少
+    SegmentLRUCache(int capacity, size_t memoryBudget, size_t segmentSize = 1 << 20, double fillRatio = 0.9)
+        : capacity(capacity)
+        , fillRatio(fillRatio)
+        , store(memoryBudget, segmentSize)
+        , stopCompactor_(false)
+    {
+        store.setRelocateCallback([](void* owner, SegmentStore::Location location)
+        {
+            static_cast<Entry*>(owner)->location = location;
+        });
+    }
+
+    ~SegmentLRUCache() override
+    {
+        stopCompaction();
+    }
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    // value字节总要复制进段中 右值与左值相同
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, value);
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        entries.splice(entries.end(), entries, it->second);
+        std::string_view bytes = store.read(it->second->location);
+        value.assign(bytes.data(), bytes.size());
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it != index.end())
+            removeEntry(it->second);
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries.size();
+    }
+
+    // 存活value记录占用的字节
+    size_t liveBytes()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return store.liveBytes();
+    }
+
+    // 段存储当前向系统申请的字节 不超过预算
+    size_t allocatedBytes()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return store.allocatedBytes();
+    }
+
+    // 清理一轮: 合并存活率低于maxLiveRatio的段 返回释放的段数
+    size_t compact(double maxLiveRatio = 0.5)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return store.compact(maxLiveRatio);
+    }
+
+    // 启动后台清理线程 每隔interval执行一次compact
+    void startCompaction(std::chrono::milliseconds interval, double maxLiveRatio = 0.5)
+    {
+        std::lock_guard<std::mutex> lock(compactorMutex);
+        if(compactor.joinable())
+            return;
+        stopCompactor_ = false;
+        compactor = std::thread([this, interval, maxLiveRatio]()
+        {
+            std::unique_lock<std::mutex> lock(compactorMutex);
+            while(!compactorCond.wait_for(lock, interval, [this]() { return stopCompactor_; }))
+            {
+                lock.unlock();
+                compact(maxLiveRatio);
+                lock.lock();
+            }
+        });
+    }
+
+    // 停止后台清理线程
+    void stopCompaction()
+    {
+        {
+            std::lock_guard<std::mutex> lock(compactorMutex);
+            stopCompactor_ = true;
+        }
+        compactorCond.notify_all();
+        if(compactor.joinable())
+            compactor.join();
+    }
+};
+
+}   // namespace Cache
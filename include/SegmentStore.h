@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace Cache
+{
+
+// 日志结构的value存储: value字节顺序追加在固定大小的段(segment)中 不经过全局分配器
+// - 记录格式: [owner指针 8字节][长度 4字节][填充 4字节][内容] 按8字节对齐 owner为空表示已删除
+// - 每个段记录活跃字节数 段内记录全部删除时整段一次性归还系统(munmap)
+// - 清理(compaction): 把活跃字节最少的若干段中的存活记录搬到一个空段 再释放这些段
+//   搬动时通过回调告知owner新位置; 总段数固定 始终保留一个空段供清理使用 内存占用不超过预算
+// 非线程安全 由使用者加锁
+class SegmentStore
+{
+public:
+    struct Location
+    {
+        uint32_t segment;
+        uint32_t offset;
+    };
+
+    // 记录被搬动时调用: (owner, 新位置)
+    using RelocateCallback = std::function<void(void* owner, Location location)>;
+
+    static constexpr size_t HeaderSize = 16;
+
+    SegmentStore(size_t budgetBytes, size_t segmentSize)
+        : segmentSize(alignUp(std::max<size_t>(segmentSize, 256)))
+        , active(None)
+        , live(0)
+        , allocated(0)
+    {
+        size_t count = std::max<size_t>(2, budgetBytes / this->segmentSize);
+        segments.resize(count);
+        for(size_t i = count; i-- > 0; )
+            freeSegments.push_back(static_cast<uint32_t>(i));
+    }
+
+    ~SegmentStore()
+    {
+        for(Segment& segment : segments)
+            unmapSegment(segment);
+    }
+
+    SegmentStore(const SegmentStore&) = delete;
+    SegmentStore& operator=(const SegmentStore&) = delete;
+
+    void setRelocateCallback(RelocateCallback callback) { relocate = std::move(callback); }
+
+    // 一条内容为size字节的记录占用的空间
+    static size_t recordSize(size_t size) { return HeaderSize + alignUp(size); }
+
+    // 单条记录的最大内容长度
+    size_t maxValueSize() const { return segmentSize - HeaderSize; }
+
+    // 存活记录可占用的上限: 除清理预留段外的空间按fillRatio计算 留出余量保证清理总能腾出空间
+    size_t liveLimit(double fillRatio = 0.9) const
+    {
+        return static_cast<size_t>((segments.size() - 1) * segmentSize * fillRatio);
+    }
+
+    size_t liveBytes() const { return live; }
+    size_t allocatedBytes() const { return allocated; }
+    size_t budgetBytes() const { return segments.size() * segmentSize; }
+
+    // 追加一条记录 空间不足(清理也腾不出)时返回false 由调用者淘汰一些记录后重试
+    bool append(const char* data, size_t size, void* owner, Location& location)
+    {
+        size_t bytes = recordSize(size);
+        if(size > maxValueSize())
+            return false;
+        if(active == None || segments[active].used + bytes > segmentSize)
+        {
+            if(!openSegment(bytes))
+                return false;
+        }
+        location.segment = active;
+        location.offset = static_cast<uint32_t>(segments[active].used);
+        writeRecord(segments[active], data, size, owner);
+        return true;
+    }
+
+    std::string_view read(Location location) const
+    {
+        const char* record = segments[location.segment].data + location.offset;
+        uint32_t length;
+        std::memcpy(&length, record + sizeof(void*), sizeof(uint32_t));
+        return std::string_view(record + HeaderSize, length);
+    }
+
+    // 删除记录 所在段(非当前写入段)不再有存活记录时整段释放
+    void release(Location location)
+    {
+        Segment& segment = segments[location.segment];
+        char* record = segment.data + location.offset;
+        uint32_t length;
+        std::memcpy(&length, record + sizeof(void*), sizeof(uint32_t));
+        void* none = nullptr;
+        std::memcpy(record, &none, sizeof(void*));
+        size_t bytes = recordSize(length);
+        segment.live -= bytes;
+        live -= bytes;
+        if(segment.live == 0 && location.segment != active)
+            freeSegment(location.segment);
+    }
+
+    // 后台清理: 把存活率低于maxLiveRatio的段合并搬到空段中 返回释放的段数
+    // 每轮至少合并两个段才有净收益
+    size_t compact(double maxLiveRatio)
+    {
+        size_t freed = 0;
+        while(freeSegments.size() >= 1)
+        {
+            std::vector<uint32_t> victims = pickVictims(segmentSize, maxLiveRatio);
+            if(victims.size() < 2)
+                break;
+            evacuate(victims);
+            freed += victims.size() - 1;
+        }
+        return freed;
+    }
+
+private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    struct Segment
+    {
+        char* data = nullptr;
+        size_t used = 0;    // 已写入字节
+        size_t live = 0;    // 存活记录字节
+    };
+
+    size_t segmentSize;
+    std::vector<Segment> segments;
+    std::vector<uint32_t> freeSegments;     // 未映射内存的段
+    uint32_t active;                        // 当前写入段
+    size_t live;
+    size_t allocated;
+    RelocateCallback relocate;
+
+    static size_t alignUp(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+    void mapSegment(Segment& segment)
+    {
+#ifndef _WIN32
+        void* memory = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        segment.data = memory == MAP_FAILED ? nullptr : static_cast<char*>(memory);
+#else
+        segment.data = static_cast<char*>(std::malloc(segmentSize));
+#endif
+        segment.used = 0;
+        segment.live = 0;
+        if(segment.data)
+            allocated += segmentSize;
+    }
+
+    void unmapSegment(Segment& segment)
+    {
+        if(!segment.data)
+            return;
+#ifndef _WIN32
+        munmap(segment.data, segmentSize);
+#else
+        std::free(segment.data);
+#endif
+        segment.data = nullptr;
+        allocated -= segmentSize;
+    }
+
+    void freeSegment(uint32_t index)
+    {
+        unmapSegment(segments[index]);
+        freeSegments.push_back(index);
+    }
+
+    uint32_t takeFreeSegment()
+    {
+        uint32_t index = freeSegments.back();
+        freeSegments.pop_back();
+        mapSegment(segments[index]);
+        if(!segments[index].data)
+        {
+            freeSegments.push_back(index);
+            return None;
+        }
+        return index;
+    }
+
+    void writeRecord(Segment& segment, const char* data, size_t size, void* owner)
+    {
+        char* record = segment.data + segment.used;
+        uint32_t length = static_cast<uint32_t>(size);
+        std::memcpy(record, &owner, sizeof(void*));
+        std::memcpy(record + sizeof(void*), &length, sizeof(uint32_t));
+        std::memcpy(record + HeaderSize, data, size);
+        size_t bytes = recordSize(size);
+        segment.used += bytes;
+        segment.live += bytes;
+        live += bytes;
+    }
+
+    // 切换写入段: 优先使用空段(保留最后一个供清理) 否则清理活跃字节最少的段腾出空间
+    bool openSegment(size_t bytes)
+    {
+        if(active != None)
+        {
+            uint32_t previous = active;
+            active = None;
+            if(segments[previous].live == 0)
+                freeSegment(previous);
+        }
+        if(freeSegments.size() > 1)
+        {
+            active = takeFreeSegment();
+            return active != None;
+        }
+        if(freeSegments.empty())
+            return false;
+        std::vector<uint32_t> victims = pickVictims(segmentSize - bytes, 1.0);
+        if(victims.empty())
+            return false;
+        active = evacuate(victims);
+        return active != None && segments[active].used + bytes <= segmentSize;
+    }
+
+    // 按活跃字节从少到多挑选段 总活跃字节不超过limit 且各段存活率低于maxLiveRatio
+    std::vector<uint32_t> pickVictims(size_t limit, double maxLiveRatio) const
+    {
+        std::vector<uint32_t> candidates;
+        for(uint32_t i=0; i<segments.size(); i++)
+        {
+            if(i == active || !segments[i].data)
+                continue;
+            if(segments[i].live < segmentSize * maxLiveRatio)
+                candidates.push_back(i);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+        {
+            return segments[a].live < segments[b].live;
+        });
+        std::vector<uint32_t> victims;
+        size_t total = 0;
+        for(uint32_t index : candidates)
+        {
+            if(total + segments[index].live > limit)
+                break;
+            total += segments[index].live;
+            victims.push_back(index);
+        }
+        return victims;
+    }
+
+    // 把victims中的存活记录搬到一个空段 释放victims 返回接收段
+    uint32_t evacuate(const std::vector<uint32_t>& victims)
+    {
+        uint32_t target = takeFreeSegment();
+        if(target == None)
+            return None;
+        for(uint32_t index : victims)
+        {
+            Segment& source = segments[index];
+            size_t offset = 0;
+            while(offset < source.used)
+            {
+                const char* record = source.data + offset;
+                void* owner;
+                uint32_t length;
+                std::memcpy(&owner, record, sizeof(void*));
+                std::memcpy(&length, record + sizeof(void*), sizeof(uint32_t));
+                size_t bytes = recordSize(length);
+                if(owner)
+                {
+                    Location location{target, static_cast<uint32_t>(segments[target].used)};
+                    writeRecord(segments[target], record + HeaderSize, length, owner);
+                    live -= bytes;
+                    if(relocate)
+                        relocate(owner, location);
+                }
+                offset += bytes;
+            }
+            source.live = 0;
+            freeSegment(index);
+        }
+        return target;
+    }
+};
+
+}   // namespace Cache
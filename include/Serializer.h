@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace Cache
+{
+
+// key/value的二进制编码(快照、闪存层共用): 可平凡复制的类型按原始字节 std::string为u32长度 + 内容
+// 其他类型可特化Serializer 提供write(out, value)与read(p, end, value)
+template<typename T, typename = void>
+struct Serializer;
+
+template<typename T>
+struct Serializer<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type>
+{
+    static void write(std::string& out, const T& value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool read(const char*& p, const char* end, T& value)
+    {
+        if(static_cast<size_t>(end - p) < sizeof(T))
+            return false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+template<>
+struct Serializer<std::string>
+{
+    static void write(std::string& out, const std::string& value)
+    {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(value);
+    }
+
+    static bool read(const char*& p, const char* end, std::string& value)
+    {
+        uint32_t length;
+        if(!Serializer<uint32_t>::read(p, end, length) || static_cast<size_t>(end - p) < length)
+            return false;
+        value.assign(p, length);
+        p += length;
+        return true;
+    }
+};
+
+}   // namespace Cache
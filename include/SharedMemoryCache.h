@@ -0,0 +1,591 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "CachePolicy.h"
+#include "Serializer.h"
+
+namespace Cache
+{
+
+// 跨进程共享的LRU缓存: 索引与value都放在一块共享内存映射中 同一主机上的多个工作进程共用一份缓存
+// - name以'/'开头时用shm_open按名称打开(不存在则创建并初始化) 无关进程按同名共享; name为空时为匿名共享映射 只与fork出的子进程共享
+// - 映射内只用下标与偏移 不存指针 各进程映射到不同地址也可使用
+// - 按key哈希分为shardCount个分片 每片一把进程间共享的健壮(robust)互斥锁 一个固定大小的槽位数组、哈希桶与LRU链表
+//   capacity按分片均分 余数分给前几个分片 各分片条目数之和恰为capacity; 分片数不超过capacity
+// - key与value经Serializer编码后放入槽位 编码超过slotBytes的条目不放入(并删去该key的旧值)
+// - 持锁进程崩溃后 下一个加锁的进程清空该分片再继续使用(缓存内容可以丢弃 不尝试修复)
+// 各进程须为同一程序构建(key的哈希与编码一致) 且以相同的capacity/slotBytes/shardCount打开
+template<typename Key, typename Value>
+class SharedMemoryCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    static constexpr uint32_t Nil = 0xffffffffu;
+    static constexpr uint32_t Magic = 0x4d485343;       // "CSHM"
+    static constexpr uint32_t LayoutVersion = 2;
+
+    enum State : uint32_t
+    {
+        Initializing = 0,
+        Ready = 1
+    };
+
+    struct Header
+    {
+        std::atomic<uint32_t> state;
+        uint32_t magic;
+        uint32_t layoutVersion;
+        uint32_t shardCount;
+        uint32_t slotsPerShard;
+        uint32_t bucketsPerShard;
+        uint32_t slotBytes;
+        uint64_t capacity;
+        uint64_t totalBytes;
+    };
+
+    // 分片头 计数器供所有进程汇总(sharedStats)
+    struct alignas(64) Shard
+    {
+#ifndef _WIN32
+        pthread_mutex_t mutex;
+#endif
+        uint32_t head;                  // 最近访问
+        uint32_t tail;                  // 最久未访问
+        uint32_t freeHead;              // 空闲槽位链(经next串起)
+        uint32_t size;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        std::atomic<uint64_t> puts;
+        std::atomic<uint64_t> evictions;
+    };
+
+    // 槽位头 其后紧跟slotBytes字节的编码数据
+    struct Slot
+    {
+        uint32_t prev;
+        uint32_t next;
+        uint32_t chain;                 // 同一哈希桶的下一个槽位
+        uint32_t hash;                  // 哈希高32位 比较key前先过滤
+        uint32_t bytes;                 // 编码数据长度
+    };
+
+private:
+    size_t capacity;
+    uint32_t shardCount;
+    uint32_t slotsPerShard;             // 每个分片的槽位数组长度 实际可用的槽位数见shardSlots
+    uint32_t bucketsPerShard;
+    uint32_t slotBytes;
+    size_t slotStride;
+    size_t bucketsOffset;
+    size_t slotsOffset;
+    size_t totalBytes;
+    char* base;
+
+    static size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // 整数key的std::hash通常是恒等映射 再混合一次: 高位选分片与过滤 低位选桶
+    static uint64_t hash(LookupType key)
+    {
+        uint64_t h = typename KeyTraits<Key>::Hasher()(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    Header& header() { return *reinterpret_cast<Header*>(base); }
+    Shard& shard(uint32_t index) { return reinterpret_cast<Shard*>(base + alignUp(sizeof(Header), 64))[index]; }
+
+    uint32_t* buckets(uint32_t shardIndex)
+    {
+        return reinterpret_cast<uint32_t*>(base + bucketsOffset) + static_cast<size_t>(shardIndex) * bucketsPerShard;
+    }
+
+    Slot& slot(uint32_t shardIndex, uint32_t index)
+    {
+        size_t global = static_cast<size_t>(shardIndex) * slotsPerShard + index;
+        return *reinterpret_cast<Slot*>(base + slotsOffset + global * slotStride);
+    }
+
+    static char* data(Slot& s) { return reinterpret_cast<char*>(&s + 1); }
+
+    // 各线程复用的编码/解码缓冲区
+    static std::string& scratch()
+    {
+        static thread_local std::string buffer;
+        return buffer;
+    }
+
+    static Key& scratchKey()
+    {
+        static thread_local Key key{};
+        return key;
+    }
+
+    // 分片可用的槽位数: capacity均分 前capacity % shardCount个分片多一个
+    uint32_t shardSlots(uint32_t index) const
+    {
+        return static_cast<uint32_t>(capacity / shardCount + (index < capacity % shardCount ? 1 : 0));
+    }
+
+    // 清空分片: 可用槽位放回空闲链 桶置空(初始化与持锁进程崩溃后使用)
+    void resetShard(uint32_t index)
+    {
+        Shard& s = shard(index);
+        uint32_t* bucket = buckets(index);
+        for(uint32_t i=0; i<bucketsPerShard; i++)
+            bucket[i] = Nil;
+        uint32_t slots = shardSlots(index);
+        for(uint32_t i=0; i<slots; i++)
+            slot(index, i).next = i + 1 < slots ? i + 1 : Nil;
+        s.head = s.tail = Nil;
+        s.freeHead = slots > 0 ? 0 : Nil;
+        s.size = 0;
+    }
+
+#ifndef _WIN32
+    // 分片锁 加锁时发现上一个持有者已退出 -> 分片状态可能不完整 清空后继续
+    class ShardLock
+    {
+    public:
+        ShardLock(SharedMemoryCache& cache, uint32_t index)
+            : mutex(&cache.shard(index).mutex)
+        {
+            int result = pthread_mutex_lock(mutex);
+            if(result == EOWNERDEAD)
+            {
+                cache.resetShard(index);
+                pthread_mutex_consistent(mutex);
+                result = 0;
+            }
+            locked = result == 0;
+        }
+
+        ~ShardLock()
+        {
+            if(locked)
+                pthread_mutex_unlock(mutex);
+        }
+
+        bool owns() const { return locked; }
+
+    private:
+        pthread_mutex_t* mutex;
+        bool locked;
+    };
+#endif
+
+    void unlinkLRU(uint32_t shardIndex, uint32_t index)
+    {
+        Shard& s = shard(shardIndex);
+        Slot& node = slot(shardIndex, index);
+        if(node.prev != Nil)
+            slot(shardIndex, node.prev).next = node.next;
+        else
+            s.head = node.next;
+        if(node.next != Nil)
+            slot(shardIndex, node.next).prev = node.prev;
+        else
+            s.tail = node.prev;
+    }
+
+    void pushFront(uint32_t shardIndex, uint32_t index)
+    {
+        Shard& s = shard(shardIndex);
+        Slot& node = slot(shardIndex, index);
+        node.prev = Nil;
+        node.next = s.head;
+        if(s.head != Nil)
+            slot(shardIndex, s.head).prev = index;
+        else
+            s.tail = index;
+        s.head = index;
+    }
+
+    // 从桶链中摘除 prevInChain为链上的前一个槽位(Nil表示桶头)
+    void unlinkChain(uint32_t shardIndex, uint32_t bucket, uint32_t prevInChain, uint32_t index)
+    {
+        uint32_t next = slot(shardIndex, index).chain;
+        if(prevInChain == Nil)
+            buckets(shardIndex)[bucket] = next;
+        else
+            slot(shardIndex, prevInChain).chain = next;
+    }
+
+    // 在分片中查找key 找到时返回槽位并给出链上的前一个槽位
+    uint32_t find(uint32_t shardIndex, uint64_t h, LookupType key, uint32_t& prevInChain)
+    {
+        uint32_t tag = static_cast<uint32_t>(h >> 32);
+        prevInChain = Nil;
+        for(uint32_t index = buckets(shardIndex)[h & (bucketsPerShard - 1)]; index != Nil; )
+        {
+            Slot& node = slot(shardIndex, index);
+            if(node.hash == tag)
+            {
+                const char* p = data(node);
+                Key& stored = scratchKey();
+                if(Serializer<Key>::read(p, p + node.bytes, stored) && stored == key)
+                    return index;
+            }
+            prevInChain = index;
+            index = node.chain;
+        }
+        return Nil;
+    }
+
+    // 删除槽位: 摘出桶链与LRU链 放回空闲链
+    void release(uint32_t shardIndex, uint32_t bucket, uint32_t prevInChain, uint32_t index)
+    {
+        Shard& s = shard(shardIndex);
+        unlinkChain(shardIndex, bucket, prevInChain, index);
+        unlinkLRU(shardIndex, index);
+        slot(shardIndex, index).next = s.freeHead;
+        s.freeHead = index;
+        s.size--;
+    }
+
+    // 驱逐最久未访问的槽位 有监听时解码后交给监听
+    void evictTail(uint32_t shardIndex)
+    {
+        Shard& s = shard(shardIndex);
+        uint32_t victim = s.tail;
+        Slot& node = slot(shardIndex, victim);
+        const char* p = data(node);
+        const char* end = p + node.bytes;
+        Key key{};
+        Serializer<Key>::read(p, end, key);
+        if(this->evictionListener)
+        {
+            Value value{};
+            if(Serializer<Value>::read(p, end, value))
+                this->notifyEviction(key, value);
+        }
+        uint64_t h = hash(key);
+        uint32_t bucket = static_cast<uint32_t>(h & (bucketsPerShard - 1));
+        uint32_t prevInChain = Nil;
+        for(uint32_t index = buckets(shardIndex)[bucket]; index != victim; index = slot(shardIndex, index).chain)
+            prevInChain = index;
+        release(shardIndex, bucket, prevInChain, victim);
+        s.evictions.fetch_add(1, std::memory_order_relaxed);
+        this->statsCounter.record(StatsCounter::Eviction);
+    }
+
+    void store(const Key& key, const Value& value)
+    {
+        this->statsCounter.record(StatsCounter::Put);
+        if(!base)
+            return;
+        std::string& record = scratch();
+        record.clear();
+        Serializer<Key>::write(record, key);
+        Serializer<Value>::write(record, value);
+
+        uint64_t h = hash(key);
+        uint32_t shardIndex = static_cast<uint32_t>((h >> 32) % shardCount);
+        uint32_t bucket = static_cast<uint32_t>(h & (bucketsPerShard - 1));
+#ifndef _WIN32
+        ShardLock lock(*this, shardIndex);
+        if(!lock.owns())
+            return;
+#endif
+        Shard& s = shard(shardIndex);
+        s.puts.fetch_add(1, std::memory_order_relaxed);
+        uint32_t prevInChain;
+        uint32_t index = find(shardIndex, h, key, prevInChain);
+        if(record.size() > slotBytes)
+        {
+            // 放不下 -> 删去旧值 避免之后读到过期数据
+            if(index != Nil)
+                release(shardIndex, bucket, prevInChain, index);
+            return;
+        }
+        if(index != Nil)
+        {
+            unlinkLRU(shardIndex, index);
+        }
+        else
+        {
+            if(s.freeHead == Nil)
+                evictTail(shardIndex);
+            index = s.freeHead;
+            s.freeHead = slot(shardIndex, index).next;
+            slot(shardIndex, index).chain = buckets(shardIndex)[bucket];
+            buckets(shardIndex)[bucket] = index;
+            s.size++;
+        }
+        Slot& node = slot(shardIndex, index);
+        node.hash = static_cast<uint32_t>(h >> 32);
+        node.bytes = static_cast<uint32_t>(record.size());
+        std::memcpy(data(node), record.data(), record.size());
+        pushFront(shardIndex, index);
+    }
+
+    // 映射共享内存 按名称打开时由创建者初始化 其他进程等待初始化完成并核对布局
+    bool map(const std::string& name)
+    {
+#ifndef _WIN32
+        bool creator = true;
+        int fd = -1;
+        if(!name.empty())
+        {
+            fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if(fd < 0 && errno == EEXIST)
+            {
+                creator = false;
+                fd = shm_open(name.c_str(), O_RDWR, 0600);
+            }
+            if(fd < 0)
+                return false;
+            if(creator && ftruncate(fd, static_cast<off_t>(totalBytes)) != 0)
+            {
+                ::close(fd);
+                shm_unlink(name.c_str());
+                return false;
+            }
+            // 创建者可能尚未设置大小(一次ftruncate设置 非0即为最终大小 与本进程不同则布局不符)
+            struct stat info;
+            for(int i=0; !creator && i<1000; i++)
+            {
+                if(fstat(fd, &info) == 0 && info.st_size != 0)
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if(!creator && (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != totalBytes))
+            {
+                ::close(fd);
+                return false;
+            }
+        }
+        int flags = fd < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+        void* address = mmap(nullptr, totalBytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if(fd >= 0)
+            ::close(fd);
+        if(address == MAP_FAILED)
+            return false;
+        base = static_cast<char*>(address);
+
+        if(creator)
+        {
+            initialize();
+            return true;
+        }
+        // 等待创建者初始化 超时(创建者初始化中途退出)视为失败
+        Header& h = header();
+        for(int i=0; i<5000 && h.state.load(std::memory_order_acquire) != Ready; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if(h.state.load(std::memory_order_acquire) != Ready || h.magic != Magic || h.layoutVersion != LayoutVersion ||
+           h.shardCount != shardCount || h.capacity != capacity || h.slotsPerShard != slotsPerShard || h.slotBytes != slotBytes ||
+           h.totalBytes != totalBytes)
+        {
+            munmap(base, totalBytes);
+            base = nullptr;
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void initialize()
+    {
+#ifndef _WIN32
+        Header* h = new (base) Header();
+        h->magic = Magic;
+        h->layoutVersion = LayoutVersion;
+        h->shardCount = shardCount;
+        h->slotsPerShard = slotsPerShard;
+        h->bucketsPerShard = bucketsPerShard;
+        h->slotBytes = slotBytes;
+        h->capacity = capacity;
+        h->totalBytes = totalBytes;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        for(uint32_t i=0; i<shardCount; i++)
+        {
+            Shard* s = new (&shard(i)) Shard();
+            pthread_mutex_init(&s->mutex, &attr);
+            resetShard(i);
+        }
+        pthread_mutexattr_destroy(&attr);
+        h->state.store(Ready, std::memory_order_release);
+#endif
+    }
+
+public:
+    // name: 共享内存名称(如"/page-cache") 为空则为匿名映射   capacity: 总条目数(至少为1)
+    // slotBytes: 每个条目编码后(key + value)的最大字节数   shardCount: 分片数(不超过capacity)
+    SharedMemoryCache(const std::string& name, size_t capacity, size_t slotBytes = 256, uint32_t shardCount = 16)
+        : capacity(std::max<size_t>(capacity, 1))
+        , shardCount(static_cast<uint32_t>(std::min<size_t>(std::max<uint32_t>(shardCount, 1), this->capacity)))
+        , slotsPerShard(static_cast<uint32_t>((this->capacity + this->shardCount - 1) / this->shardCount))
+        , bucketsPerShard(1)
+        , slotBytes(static_cast<uint32_t>(slotBytes))
+        , base(nullptr)
+    {
+        while(bucketsPerShard < slotsPerShard)
+            bucketsPerShard <<= 1;
+        slotStride = alignUp(sizeof(Slot) + slotBytes, alignof(Slot));
+        bucketsOffset = alignUp(sizeof(Header), 64) + sizeof(Shard) * this->shardCount;
+        slotsOffset = alignUp(bucketsOffset + sizeof(uint32_t) * bucketsPerShard * this->shardCount, 64);
+        totalBytes = slotsOffset + slotStride * slotsPerShard * this->shardCount;
+        map(name);
+    }
+
+    // 只解除本进程的映射 共享内存由unlink删除
+    ~SharedMemoryCache() override
+    {
+#ifndef _WIN32
+        if(base)
+            munmap(base, totalBytes);
+#endif
+    }
+
+    SharedMemoryCache(const SharedMemoryCache&) = delete;
+    SharedMemoryCache& operator=(const SharedMemoryCache&) = delete;
+
+    // 删除具名共享内存 已映射的进程不受影响 之后同名打开将重新创建
+    static bool unlink(const std::string& name)
+    {
+#ifndef _WIN32
+        return shm_unlink(name.c_str()) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // 映射是否可用 失败时(布局不符、权限不足等)所有get未命中 put不生效
+    bool ok() const { return base != nullptr; }
+
+    void put(const Key& key, const Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        store(key, value);
+    }
+
+    // value总是编码复制进共享内存 右值版本与左值版本相同
+    void put(const Key& key, Value&& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        store(key, value);
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        bool hit = false;
+        if(base)
+        {
+            uint64_t h = hash(key);
+            uint32_t shardIndex = static_cast<uint32_t>((h >> 32) % shardCount);
+#ifndef _WIN32
+            ShardLock lock(*this, shardIndex);
+            if(lock.owns())
+#endif
+            {
+                uint32_t prevInChain;
+                uint32_t index = find(shardIndex, h, key, prevInChain);
+                if(index != Nil)
+                {
+                    Slot& node = slot(shardIndex, index);
+                    const char* p = data(node);
+                    const char* end = p + node.bytes;
+                    hit = Serializer<Key>::read(p, end, scratchKey()) && Serializer<Value>::read(p, end, value);
+                    unlinkLRU(shardIndex, index);
+                    pushFront(shardIndex, index);
+                }
+                Shard& s = shard(shardIndex);
+                (hit ? s.hits : s.misses).fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        this->statsCounter.record(hit ? StatsCounter::Hit : StatsCounter::Miss);
+        return hit;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除key 返回是否存在
+    bool remove(LookupType key)
+    {
+        if(!base)
+            return false;
+        uint64_t h = hash(key);
+        uint32_t shardIndex = static_cast<uint32_t>((h >> 32) % shardCount);
+#ifndef _WIN32
+        ShardLock lock(*this, shardIndex);
+        if(!lock.owns())
+            return false;
+#endif
+        uint32_t prevInChain;
+        uint32_t index = find(shardIndex, h, key, prevInChain);
+        if(index == Nil)
+            return false;
+        release(shardIndex, static_cast<uint32_t>(h & (bucketsPerShard - 1)), prevInChain, index);
+        return true;
+    }
+
+    // 所有进程共享的条目数
+    size_t size()
+    {
+        size_t total = 0;
+        for(uint32_t i=0; base && i<shardCount; i++)
+        {
+#ifndef _WIN32
+            ShardLock lock(*this, i);
+            if(lock.owns())
+#endif
+                total += shard(i).size;
+        }
+        return total;
+    }
+
+    // 所有进程合计的命中/未命中/放入/驱逐 (stats()只统计本进程)
+    CacheStats sharedStats()
+    {
+        CacheStats result;
+        for(uint32_t i=0; base && i<shardCount; i++)
+        {
+            Shard& s = shard(i);
+            result.hits += s.hits.load(std::memory_order_relaxed);
+            result.misses += s.misses.load(std::memory_order_relaxed);
+            result.puts += s.puts.load(std::memory_order_relaxed);
+            result.evictions += s.evictions.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    // 共享内存映射的总字节数
+    size_t mappedBytes() const { return totalBytes; }
+};
+
+}   // namespace Cache
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "LRU_CachePolicy.h"
+#include "LFU_CachePolicy.h"
+#include "Serializer.h"
+
+namespace Cache
+{
+
+// 快照对应的策略 恢复时须一致
+enum class SnapshotKind : uint32_t
+{
+    LRU = 1,    // 条目按从最久未使用到最近使用排列
+    LFU = 2     // 每个条目附带访问频次
+};
+
+// 快照文件格式(小端):
+//   文件头 32字节: 魔数"CACHESNP" 版本u32 策略u32 条目数u64 块数u64
+//   若干块: 块头16字节(条目数u32 字节数u32 校验和u64) + 条目[key value meta(u32)]
+// 按块独立校验与解码 恢复时多个线程并行解码 按块顺序放入缓存
+namespace SnapshotFormat
+{
+constexpr char Magic[8] = {'C', 'A', 'C', 'H', 'E', 'S', 'N', 'P'};
+constexpr uint32_t Version = 1;
+constexpr size_t HeaderSize = 32;
+constexpr size_t ChunkHeaderSize = 16;
+
+// 按8字节分组的FNV式校验和 检出截断与损坏
+inline uint64_t checksum(const char* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    for(; i < size; i++)
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ull;
+    return hash;
+}
+}   // namespace SnapshotFormat
+
+// 快照写入: 先写临时文件 完成后fsync并重命名为目标文件 -> 中途失败或崩溃不会留下半个快照
+// add只把条目编码进内存中的当前块 适合在缓存锁内调用; flushFull在锁外把写满的块写入文件
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(const std::string& path, SnapshotKind kind, size_t chunkBytes = 1 << 20)
+        : path(path)
+        , tempPath(path + ".tmp")
+        , kind(kind)
+        , chunkBytes(chunkBytes)
+        , chunkEntries(0)
+        , entries(0)
+        , chunks(0)
+        , failed(false)
+        , finished(false)
+    {
+        file = std::fopen(tempPath.c_str(), "wb");
+        // 文件头先占位 完成时回填条目数与块数
+        char header[SnapshotFormat::HeaderSize] = {};
+        failed = !file || std::fwrite(header, 1, sizeof(header), file) != sizeof(header);
+    }
+
+    ~SnapshotWriter()
+    {
+        if(file)
+            std::fclose(file);
+        if(!finished)
+            std::remove(tempPath.c_str());
+    }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool ok() const { return !failed; }
+
+    template<typename Key, typename Value>
+    void add(const Key& key, const Value& value, uint32_t meta = 0)
+    {
+        Serializer<Key>::write(chunk, key);
+        Serializer<Value>::write(chunk, value);
+        Serializer<uint32_t>::write(chunk, meta);
+        chunkEntries++;
+    }
+
+    // 当前块达到chunkBytes时写入文件
+    bool flushFull()
+    {
+        if(chunk.size() >= chunkBytes)
+            writeChunk();
+        return !failed;
+    }
+
+    // 写入剩余条目 回填文件头 落盘后原子替换目标文件
+    bool finish()
+    {
+        if(chunkEntries > 0)
+            writeChunk();
+        if(failed)
+            return false;
+        char header[SnapshotFormat::HeaderSize] = {};
+        uint32_t version = SnapshotFormat::Version;
+        uint32_t kindValue = static_cast<uint32_t>(kind);
+        std::memcpy(header, SnapshotFormat::Magic, sizeof(SnapshotFormat::Magic));
+        std::memcpy(header + 8, &version, sizeof(version));
+        std::memcpy(header + 12, &kindValue, sizeof(kindValue));
+        std::memcpy(header + 16, &entries, sizeof(entries));
+        std::memcpy(header + 24, &chunks, sizeof(chunks));
+        if(std::fseek(file, 0, SEEK_SET) != 0 || std::fwrite(header, 1, sizeof(header), file) != sizeof(header) ||
+           std::fflush(file) != 0)
+            return false;
+#ifndef _WIN32
+        if(fsync(fileno(file)) != 0)
+            return false;
+#endif
+        std::fclose(file);
+        file = nullptr;
+        if(std::rename(tempPath.c_str(), path.c_str()) != 0)
+            return false;
+        finished = true;
+        return true;
+    }
+
+private:
+    std::string path;
+    std::string tempPath;
+    SnapshotKind kind;
+    size_t chunkBytes;
+    std::FILE* file;
+    std::string chunk;          // 当前块的条目编码
+    uint32_t chunkEntries;
+    uint64_t entries;
+    uint64_t chunks;
+    bool failed;
+    bool finished;
+
+    void writeChunk()
+    {
+        if(failed)
+            return;
+        char header[SnapshotFormat::ChunkHeaderSize];
+        uint32_t bytes = static_cast<uint32_t>(chunk.size());
+        uint64_t sum = SnapshotFormat::checksum(chunk.data(), chunk.size());
+        std::memcpy(header, &chunkEntries, sizeof(chunkEntries));
+        std::memcpy(header + 4, &bytes, sizeof(bytes));
+        std::memcpy(header + 8, &sum, sizeof(sum));
+        failed = std::fwrite(header, 1, sizeof(header), file) != sizeof(header) ||
+                 std::fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size();
+        entries += chunkEntries;
+        chunks++;
+        chunk.clear();
+        chunkEntries = 0;
+    }
+};
+
+// 快照读取: mmap映射文件 打开时校验文件头并建立块索引
+// load由多个线程并行校验、解码各块 当前线程按块顺序交给apply 解码最多领先若干块 内存占用有界
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const std::string& path)
+        : data(nullptr)
+        , length(0)
+        , kindValue(0)
+        , entryCount(0)
+        , valid(false)
+    {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            return;
+        struct stat info;
+        if(fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            length = static_cast<size_t>(info.st_size);
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped != MAP_FAILED)
+            {
+                madvise(mapped, length, MADV_WILLNEED);
+                data = static_cast<const char*>(mapped);
+            }
+            else
+                length = 0;
+        }
+        ::close(fd);
+        valid = data && parseIndex();
+#endif
+    }
+
+    ~SnapshotReader()
+    {
+#ifndef _WIN32
+        if(data)
+            munmap(const_cast<char*>(data), length);
+#endif
+    }
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool ok() const { return valid; }
+    SnapshotKind kind() const { return static_cast<SnapshotKind>(kindValue); }
+    uint64_t entries() const { return entryCount; }
+
+    // 依次对每个条目调用apply(Key&&, Value&&, meta) threads为解码线程数 0表示按硬件线程数
+    // 某块校验或解码失败时停止并返回false 之前的块已交给apply
+    template<typename Key, typename Value, typename Apply>
+    bool load(Apply&& apply, unsigned threads = 0)
+    {
+        if(!valid)
+            return false;
+        struct Record
+        {
+            Key key;
+            Value value;
+            uint32_t meta;
+        };
+        enum State : char { Pending, Decoded, Failed };
+
+        size_t count = chunkOffsets.size();
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(count, 1)));
+        const size_t window = threads * 2;      // 解码最多领先应用的块数
+
+        std::vector<std::vector<Record>> decoded(count);
+        std::vector<State> states(count, Pending);
+        std::mutex mutex;
+        std::condition_variable cond;
+        size_t applied = 0;
+        bool stop = false;
+        std::atomic<size_t> next{0};
+
+        auto decodeChunk = [this, &decoded](size_t index)
+        {
+            const char* chunk = data + chunkOffsets[index];
+            uint32_t entriesInChunk;
+            uint32_t bytes;
+            uint64_t sum;
+            std::memcpy(&entriesInChunk, chunk, sizeof(entriesInChunk));
+            std::memcpy(&bytes, chunk + 4, sizeof(bytes));
+            std::memcpy(&sum, chunk + 8, sizeof(sum));
+            const char* p = chunk + SnapshotFormat::ChunkHeaderSize;
+            const char* end = p + bytes;
+            if(SnapshotFormat::checksum(p, bytes) != sum)
+                return false;
+            std::vector<Record>& records = decoded[index];
+            records.resize(entriesInChunk);
+            for(Record& record : records)
+            {
+                if(!Serializer<Key>::read(p, end, record.key) || !Serializer<Value>::read(p, end, record.value) ||
+                   !Serializer<uint32_t>::read(p, end, record.meta))
+                    return false;
+            }
+            return p == end;
+        };
+
+        auto worker = [&]()
+        {
+            while(true)
+            {
+                size_t index = next.fetch_add(1);
+                if(index >= count)
+                    return;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cond.wait(lock, [&]() { return stop || index < applied + window; });
+                    if(stop)
+                        return;
+                }
+                bool success = decodeChunk(index);
+                std::lock_guard<std::mutex> lock(mutex);
+                states[index] = success ? Decoded : Failed;
+                cond.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for(unsigned i=0; i<threads; i++)
+            workers.emplace_back(worker);
+
+        bool success = true;
+        for(size_t index=0; index<count; index++)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&]() { return states[index] != Pending; });
+                if(states[index] == Failed)
+                {
+                    success = false;
+                    stop = true;
+                    cond.notify_all();
+                    break;
+                }
+            }
+            for(Record& record : decoded[index])
+                apply(std::move(record.key), std::move(record.value), record.meta);
+            std::vector<Record>().swap(decoded[index]);
+            std::lock_guard<std::mutex> lock(mutex);
+            applied = index + 1;
+            cond.notify_all();
+        }
+        for(std::thread& thread : workers)
+            thread.join();
+        return success;
+    }
+
+private:
+    const char* data;
+    size_t length;
+    uint32_t kindValue;
+    uint64_t entryCount;
+    std::vector<size_t> chunkOffsets;
+    bool valid;
+
+    // 校验文件头 记录各块起始位置 块的大小与条目数须与文件头一致
+    bool parseIndex()
+    {
+        if(length < SnapshotFormat::HeaderSize ||
+           std::memcmp(data, SnapshotFormat::Magic, sizeof(SnapshotFormat::Magic)) != 0)
+            return false;
+        uint32_t version;
+        uint64_t chunkCount;
+        std::memcpy(&version, data + 8, sizeof(version));
+        std::memcpy(&kindValue, data + 12, sizeof(kindValue));
+        std::memcpy(&entryCount, data + 16, sizeof(entryCount));
+        std::memcpy(&chunkCount, data + 24, sizeof(chunkCount));
+        if(version != SnapshotFormat::Version)
+            return false;
+
+        size_t offset = SnapshotFormat::HeaderSize;
+        uint64_t total = 0;
+        for(uint64_t i=0; i<chunkCount; i++)
+        {
+            if(length - offset < SnapshotFormat::ChunkHeaderSize)
+                return false;
+            uint32_t entriesInChunk;
+            uint32_t bytes;
+            std::memcpy(&entriesInChunk, data + offset, sizeof(entriesInChunk));
+            std::memcpy(&bytes, data + offset + 4, sizeof(bytes));
+            // 条目数不在校验和内: 每个条目至少有4字节的meta 超出即为损坏 避免解码时按伪造的条目数分配内存
+            if(length - offset - SnapshotFormat::ChunkHeaderSize < bytes || entriesInChunk > bytes / sizeof(uint32_t))
+                return false;
+            chunkOffsets.push_back(offset);
+            offset += SnapshotFormat::ChunkHeaderSize + bytes;
+            total += entriesInChunk;
+        }
+        return offset == length && total == entryCount;
+    }
+};
+
+namespace detail
+{
+// 按批导出缓存并写入快照 每批之间释放缓存锁并把写满的块写入文件
+template<typename CacheType, typename Add>
+bool writeSnapshot(CacheType& cache, SnapshotWriter& writer, size_t batchSize, Add&& add)
+{
+    if(!writer.ok() || !cache.beginExport())
+        return false;
+    bool more = true;
+    while(more)
+    {
+        more = cache.exportBatch(batchSize, add);
+        if(!writer.flushFull())
+        {
+            if(more)
+                cache.endExport();
+            return false;
+        }
+    }
+    return writer.finish();
+}
+}   // namespace detail
+
+// 保存LRU缓存的快照 -> 条目按从最久未使用到最近使用写入 导出过程中读写照常进行
+// batchSize为每次持锁导出的条目数 同一缓存同时只能有一个导出 否则返回false
+template<typename Key, typename Value>
+bool saveSnapshot(LRUCache<Key, Value>& cache, const std::string& path, size_t batchSize = 1024)
+{
+    SnapshotWriter writer(path, SnapshotKind::LRU);
+    return detail::writeSnapshot(cache, writer, batchSize, [&writer](const Key& key, const Value& value)
+    {
+        writer.add(key, value);
+    });
+}
+
+// 保存LRU-K缓存主缓存的快照 -> 与LRUCache格式相同
+template<typename Key, typename Value>
+bool saveSnapshot(LRU_KCache<Key, Value>& cache, const std::string& path, size_t batchSize = 1024)
+{
+    SnapshotWriter writer(path, SnapshotKind::LRU);
+    return detail::writeSnapshot(cache, writer, batchSize, [&writer](const Key& key, const Value& value)
+    {
+        writer.add(key, value);
+    });
+}
+
+// 保存LFU缓存的快照 -> 附带每个条目的访问频次
+template<typename Key, typename Value>
+bool saveSnapshot(LFUCache<Key, Value>& cache, const std::string& path, size_t batchSize = 1024)
+{
+    SnapshotWriter writer(path, SnapshotKind::LFU);
+    return detail::writeSnapshot(cache, writer, batchSize, [&writer](const Key& key, const Value& value, int freq)
+    {
+        writer.add(key, value, static_cast<uint32_t>(freq));
+    });
+}
+
+// 在后台线程中保存快照
+template<typename CacheType>
+std::future<bool> saveSnapshotAsync(CacheType& cache, const std::string& path, size_t batchSize = 1024)
+{
+    return std::async(std::launch::async, [&cache, path, batchSize]()
+    {
+        return saveSnapshot(cache, path, batchSize);
+    });
+}
+
+// 从快照恢复LRU缓存 按写入顺序放入即还原LRU顺序 缓存容量小于快照时保留最近使用的部分
+// threads为解码线程数 0表示按硬件线程数; 文件不存在、格式或策略不符、损坏时返回false
+template<typename Key, typename Value>
+bool loadSnapshot(LRUCache<Key, Value>& cache, const std::string& path, unsigned threads = 0)
+{
+    SnapshotReader reader(path);
+    if(!reader.ok() || reader.kind() != SnapshotKind::LRU)
+        return false;
+    return reader.load<Key, Value>([&cache](Key&& key, Value&& value, uint32_t)
+    {
+        cache.restore(key, std::move(value));
+    }, threads);
+}
+
+// 从LRU快照恢复LRU-K缓存的主缓存 恢复的条目访问次数记为K
+template<typename Key, typename Value>
+bool loadSnapshot(LRU_KCache<Key, Value>& cache, const std::string& path, unsigned threads = 0)
+{
+    SnapshotReader reader(path);
+    if(!reader.ok() || reader.kind() != SnapshotKind::LRU)
+        return false;
+    return reader.load<Key, Value>([&cache](Key&& key, Value&& value, uint32_t)
+    {
+        cache.restore(key, std::move(value));
+    }, threads);
+}
+
+// 从快照恢复LFU缓存及各条目的访问频次
+template<typename Key, typename Value>
+bool loadSnapshot(LFUCache<Key, Value>& cache, const std::string& path, unsigned threads = 0)
+{
+    SnapshotReader reader(path);
+    if(!reader.ok() || reader.kind() != SnapshotKind::LFU)
+        return false;
+    return reader.load<Key, Value>([&cache](Key&& key, Value&& value, uint32_t freq)
+    {
+        cache.restore(key, std::move(value), static_cast<int>(freq));
+    }, threads);
+}
+
+}   // namespace Cache
@@ -0,0 +1,274 @@
+#pragma once
+
+#include<atomic>
+#include<cstdint>
+#include<iterator>
+#include<memory>
+#include<mutex>
+#include<unordered_map>
+#include<vector>
+
+#include "CachePolicy.h"
+
+namespace Cache
+{
+
+// 线程本地一级缓存: 每个线程持有一个很小的2路组相联缓存 放在共享缓存(如LRU_HashCache)之前
+// - 一级命中不加锁 不写共享数据 只读一次所在分条的版本号
+// - 版本号按key哈希分条 put后所在分条版本加一 一级中记录的版本不等于当前版本即视为失效
+//   读取时先取版本再查共享缓存 -> 一级缓存不会返回比最近一次已完成的put更旧的value
+// - 共享缓存命中的条目放入一级; 一级命中不刷新共享缓存中的访问顺序
+// 绕过本层直接修改共享缓存(如remove)后需调用invalidate
+// 线程退出时把它的一级缓存归还实例 供之后新建的线程复用 -> 一级缓存数不超过同时访问过本实例的线程数峰值
+template<typename Key, typename Value>
+class ThreadLocalCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+    static constexpr size_t StripeCount = 1024;
+    static constexpr size_t Ways = 2;
+
+    struct Slot
+    {
+        Key key{};
+        Value value{};
+        uint64_t version = 0;
+        bool used = false;
+    };
+
+    // 一个线程的一级缓存 只由该线程访问
+    struct Local
+    {
+        std::vector<Slot> slots;            // sets * Ways
+        std::vector<uint8_t> recent;        // 每组最近命中的路
+        size_t setMask;
+
+        explicit Local(size_t sets) : slots(sets * Ways), recent(sets, 0), setMask(sets - 1) {}
+    };
+
+    // 本实例的全部一级缓存 线程退出时经weak_ptr归还 实例已释放则不再访问
+    struct LocalPool
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Local>> all;
+        std::vector<Local*> idle;           // 已退出线程归还的一级缓存
+
+        // 复用归还的一级缓存(其中的条目仍按版本号校验 可直接沿用) 没有则新建
+        Local* acquire(size_t sets)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!idle.empty())
+            {
+                Local* local = idle.back();
+                idle.pop_back();
+                return local;
+            }
+            all.emplace_back(new Local(sets));
+            return all.back().get();
+        }
+
+        void release(Local* local)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(local);
+        }
+    };
+
+private:
+    std::unique_ptr<Policy<Key, Value>> shared;
+    size_t sets;
+    uint64_t id;                                            // 实例编号 用于在线程本地表中区分实例
+    std::unique_ptr<std::atomic<uint64_t>[]> versions;
+    std::shared_ptr<LocalPool> pool;                        // 各线程的一级缓存 随实例释放
+    mutable StatsCounter localCounter;                      // 一级命中计数
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // 整数key的std::hash通常是恒等映射 分组与分条前再混合一次
+    static size_t mix(size_t hash)
+    {
+        uint64_t h = hash;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    static size_t hash(LookupType key)
+    {
+        return mix(typename KeyTraits<Key>::Hasher()(key));
+    }
+
+    std::atomic<uint64_t>& version(size_t h)
+    {
+        return versions[(h >> 40) & (StripeCount - 1)];
+    }
+
+    // 当前线程在本实例上的一级缓存 首次访问时从实例取得; 线程退出时归还仍存在的实例
+    Local& local()
+    {
+        struct Entry
+        {
+            std::weak_ptr<LocalPool> pool;
+            Local* local;
+        };
+        struct Registry
+        {
+            uint64_t owner = 0;
+            Local* last = nullptr;
+            std::unordered_map<uint64_t, Entry> all;
+
+            ~Registry()
+            {
+                for(auto& pair : all)
+                    if(std::shared_ptr<LocalPool> pool = pair.second.pool.lock())
+                        pool->release(pair.second.local);
+            }
+        };
+        static thread_local Registry registry;
+        if(registry.owner == id)
+            return *registry.last;
+        auto it = registry.all.find(id);
+        if(it == registry.all.end())
+        {
+            // 登记新实例时顺带删去已释放实例的记录 -> 表的大小不超过本线程访问过的存活实例数
+            for(auto stale = registry.all.begin(); stale != registry.all.end(); )
+                stale = stale->second.pool.expired() ? registry.all.erase(stale) : std::next(stale);
+            it = registry.all.emplace(id, Entry{pool, pool->acquire(sets)}).first;
+        }
+        registry.owner = id;
+        registry.last = it->second.local;
+        return *registry.last;
+    }
+
+    void bump(LookupType key)
+    {
+        version(hash(key)).fetch_add(1, std::memory_order_release);
+    }
+
+public:
+    // shared: 共享缓存   localCapacity: 每个线程一级缓存的条目数(按2路组相联取整到2的幂)
+    explicit ThreadLocalCache(std::unique_ptr<Policy<Key, Value>> shared, size_t localCapacity = 256)
+        : shared(std::move(shared))
+        , sets(1)
+        , id(nextId())
+        , versions(new std::atomic<uint64_t>[StripeCount])
+        , pool(std::make_shared<LocalPool>())
+    {
+        while(sets * Ways < localCapacity)
+            sets <<= 1;
+        for(size_t i=0; i<StripeCount; i++)
+            versions[i].store(0, std::memory_order_relaxed);
+    }
+
+    ~ThreadLocalCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        shared->put(key, value);
+        bump(key);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        shared->put(key, std::move(value));
+        bump(key);
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        size_t h = hash(key);
+        // 先取版本再查共享缓存 期间发生的put会使放入一级的条目立即失效
+        uint64_t current = version(h).load(std::memory_order_acquire);
+        Local& cache = local();
+        size_t set = h & cache.setMask;
+        Slot* slots = &cache.slots[set * Ways];
+        for(size_t way=0; way<Ways; way++)
+        {
+            Slot& slot = slots[way];
+            if(slot.used && slot.version == current && slot.key == key)
+            {
+                value = slot.value;
+                cache.recent[set] = static_cast<uint8_t>(way);
+                localCounter.record(StatsCounter::Hit);
+                this->statsCounter.record(StatsCounter::Hit);
+                return true;
+            }
+        }
+
+        if(!shared->get(key, value))
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        // 替换无效的路 否则替换最近未命中的路
+        size_t victim = 1 - cache.recent[set];
+        for(size_t way=0; way<Ways; way++)
+        {
+            if(!slots[way].used || slots[way].version != current)
+            {
+                victim = way;
+                break;
+            }
+        }
+        Slot& slot = slots[victim];
+        slot.key = Key(key);
+        slot.value = value;
+        slot.version = current;
+        slot.used = true;
+        cache.recent[set] = static_cast<uint8_t>(victim);
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 使所有线程一级缓存中的key失效 直接修改共享缓存后调用
+    void invalidate(LookupType key)
+    {
+        bump(key);
+    }
+
+    // 驱逐只发生在共享缓存中 监听转给共享缓存(一级中的副本与被驱逐的value相同 不需失效)
+    void setEvictionListener(typename Policy<Key, Value>::EvictionListener listener) override
+    {
+        shared->setEvictionListener(std::move(listener));
+    }
+
+    // 命中与未命中按两级合计 驱逐取自共享缓存
+    CacheStats stats() const override
+    {
+        CacheStats result = this->statsCounter.snapshot();
+        CacheStats inner = shared->stats();
+        result.puts = inner.puts;
+        result.evictions = inner.evictions;
+        return result;
+    }
+
+    // 一级缓存命中次数
+    uint64_t localHits() const { return localCounter.snapshot().hits; }
+
+    // 已创建的线程一级缓存数(含已退出线程归还、等待复用的)
+    size_t localCaches()
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        return pool->all.size();
+    }
+
+    Policy<Key, Value>& sharedCache() { return *shared; }
+};
+
+}   // namespace Cache
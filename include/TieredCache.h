@@ -0,0 +1,107 @@
+#pragma once
+
+#include<memory>
+#include<mutex>
+#include<string>
+
+#include "CachePolicy.h"
+#include "FlashCache.h"
+
+namespace Cache
+{
+
+// 内存 + 闪存两级缓存: 一级为任意内存策略 被它驱逐的条目降级写入FlashCache
+// - get: 一级命中直接返回; 未命中再查闪存 命中则从闪存取出并放回一级(提升)
+// - put: 写入一级并使闪存中的旧值失效
+// 同一key的提升与写入经分条锁串行 不会把旧值提升回一级覆盖新值; 一级命中不加锁
+// 每次get只访问一级一次 一级策略看到的访问序列与不加闪存层时相同
+template<typename Key, typename Value>
+class TieredCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+    static constexpr size_t StripeCount = 64;
+
+private:
+    std::unique_ptr<Policy<Key, Value>> memory;
+    FlashCache<Key, Value> flash;
+    std::mutex stripes[StripeCount];
+
+    std::mutex& stripe(LookupType key)
+    {
+        return stripes[typename KeyTraits<Key>::Hasher()(key) % StripeCount];
+    }
+
+public:
+    // memory: 一级内存策略   dir/fileBytes/regionSize: 闪存层文件所在目录、文件大小与区域大小
+    TieredCache(std::unique_ptr<Policy<Key, Value>> memory, const std::string& dir, size_t fileBytes,
+                size_t regionSize = 4 << 20)
+        : memory(std::move(memory))
+        , flash(dir, fileBytes, regionSize)
+    {
+        this->memory->setEvictionListener([this](const Key& key, const Value& value)
+        {
+            flash.insert(key, value);
+        });
+    }
+
+    ~TieredCache() override
+    {
+        memory->setEvictionListener(nullptr);
+    }
+
+    void put(const Key& key, const Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(stripe(key));
+        memory->put(key, value);
+        flash.remove(key);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(stripe(key));
+        memory->put(key, std::move(value));
+        flash.remove(key);
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        bool hit = memory->get(key, value);
+        if(!hit)
+        {
+            std::lock_guard<std::mutex> lock(stripe(key));
+            // 不再查一次一级: 每次get都会被一级策略记为一次访问(LRU-K等据此准入) 一次未命中只应计一次
+            // 等锁期间被其他线程提升的key已不在闪存中 此次按未命中返回 调用方回填即可
+            hit = flash.take(key, value);
+            if(hit)
+                memory->put(Key(key), value);
+        }
+        this->statsCounter.record(hit ? StatsCounter::Hit : StatsCounter::Miss);
+        return hit;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 命中/放入按两级合计 驱逐为离开两级的条目(闪存区域覆写与丢弃)
+    CacheStats stats() const override
+    {
+        CacheStats result = this->statsCounter.snapshot();
+        typename FlashCache<Key, Value>::Stats flashStats = const_cast<FlashCache<Key, Value>&>(flash).stats();
+        result.evictions = flashStats.evicted + flashStats.dropped;
+        return result;
+    }
+
+    Policy<Key, Value>& memoryTier() { return *memory; }
+    FlashCache<Key, Value>& flashTier() { return flash; }
+};
+
+}   // namespace Cache
@@ -0,0 +1,196 @@
+#pragma once
+
+#include<algorithm>
+#include<mutex>
+
+#include "CachePolicy.h"
+#include "IntrusiveList.h"
+#include "KeyRef.h"
+
+namespace Cache
+{
+
+// 2Q(完整版): 三个队列 -> 抗扫描 且比LRU-K省内存、少加锁
+// - A1in: 首次放入的条目 FIFO 其中再次命中不调整位置
+// - A1out: 从A1in淘汰的key(只存key不存value) 即幽灵队列
+// - Am: 主LRU 只有在A1out中被再次放入的key才进入
+// 一次扫描的key只经过A1in与A1out 不会冲掉Am中的热数据
+// 三个队列的结点共用一个结点池与一张索引 每次操作一把锁、一次查找、O(1)次链表操作
+template<typename Key, typename Value>
+class TwoQCache : public Policy<Key, Value>
+{
+    using LookupType = typename Policy<Key, Value>::LookupType;
+
+    enum Queue : unsigned char
+    {
+        In,
+        Out,
+        Main
+    };
+
+    struct Entry
+    {
+        Key key{};
+        Value value{};
+        ListHook<Entry> hook;
+        Queue queue = In;
+    };
+
+    using List = IntrusiveList<Entry, &Entry::hook>;
+
+private:
+    int capacity;                       // A1in + Am的条目数上限
+    size_t inCapacity;                  // A1in的目标长度 超过时优先从A1in淘汰
+    size_t outCapacity;                 // A1out(幽灵)的长度上限
+    NodePool<Entry> pool;
+    KeyRefMap<Key, Entry*> index;       // 三个队列共用 key引用结点内的key
+    List in;
+    List out;
+    List main;
+    std::mutex mutex_;
+
+    size_t resident() const { return in.size() + main.size(); }
+
+    // 腾出一个位置: A1in超过目标长度则把其最老条目降为幽灵 否则淘汰Am中最久未使用的条目
+    void reclaim()
+    {
+        if(in.size() > inCapacity || main.empty())
+        {
+            Entry* entry = in.popBack();
+            this->statsCounter.record(StatsCounter::Eviction);
+            this->notifyEviction(entry->key, entry->value);
+            entry->value = Value{};
+            entry->queue = Out;
+            out.pushFront(entry);
+            if(out.size() > outCapacity)
+                drop(out.popBack());
+        }
+        else
+        {
+            Entry* entry = main.popBack();
+            this->statsCounter.record(StatsCounter::Eviction);
+            this->notifyEviction(entry->key, entry->value);
+            drop(entry);
+        }
+    }
+
+    // 从索引删去并归还结点池
+    void drop(Entry* entry)
+    {
+        index.erase(entry->key);
+        entry->value = Value{};
+        pool.release(entry);
+    }
+
+    template<typename V>
+    void putValue(const Key& key, V&& value)
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Put);
+        if(capacity <= 0)
+            return;
+        this->statsCounter.record(StatsCounter::Put);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it != index.end())
+        {
+            Entry* entry = it->second;
+            if(entry->queue != Out)
+            {
+                // 已在缓存中 -> 更新value; Am中移到最近端 A1in中保持FIFO位置
+                entry->value = std::forward<V>(value);
+                if(entry->queue == Main)
+                    main.moveToFront(entry);
+                return;
+            }
+            // 幽灵命中 -> 说明不只被访问一次 放入Am
+            out.remove(entry);
+            if(resident() >= static_cast<size_t>(capacity))
+                reclaim();
+            entry->value = std::forward<V>(value);
+            entry->queue = Main;
+            main.pushFront(entry);
+            return;
+        }
+
+        if(resident() >= static_cast<size_t>(capacity))
+            reclaim();
+        Entry* entry = pool.allocate();
+        entry->key = key;
+        entry->value = std::forward<V>(value);
+        entry->queue = In;
+        in.pushFront(entry);
+        index.emplace(entry->key, entry);
+    }
+
+public:
+    // capacity: 缓存条目数   ghostCapacity: A1out长度 默认为容量的一半
+    // inRatio: A1in占容量的比例 默认25%(论文建议值)
+    explicit TwoQCache(int capacity, int ghostCapacity = 0, double inRatio = 0.25)
+        : capacity(capacity)
+        , inCapacity(std::max<size_t>(1, static_cast<size_t>(std::max(capacity, 0) * inRatio)))
+        , outCapacity(ghostCapacity > 0 ? ghostCapacity : std::max(capacity / 2, 1))
+    {}
+
+    ~TwoQCache() override = default;
+
+    void put(const Key& key, const Value& value) override
+    {
+        putValue(key, value);
+    }
+
+    void put(const Key& key, Value&& value) override
+    {
+        putValue(key, std::move(value));
+    }
+
+    bool get(LookupType key, Value& value) override
+    {
+        LatencyScope scope(this->latencyRecorder.get(), LatencyRecorder::Get);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end() || it->second->queue == Out)
+        {
+            this->statsCounter.record(StatsCounter::Miss);
+            return false;
+        }
+        Entry* entry = it->second;
+        if(entry->queue == Main)
+            main.moveToFront(entry);
+        value = entry->value;
+        this->statsCounter.record(StatsCounter::Hit);
+        return true;
+    }
+
+    Value get(LookupType key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定页(同时删去幽灵记录)
+    void remove(LookupType key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index.find(key);
+        if(it == index.end())
+            return;
+        Entry* entry = it->second;
+        (entry->queue == In ? in : entry->queue == Out ? out : main).remove(entry);
+        drop(entry);
+    }
+
+    // 缓存中的条目数(不含幽灵)
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return resident();
+    }
+
+    // 各队列长度 -> 观察A1in/Am划分与幽灵队列
+    size_t inSize() { std::lock_guard<std::mutex> lock(mutex_); return in.size(); }
+    size_t ghostSize() { std::lock_guard<std::mutex> lock(mutex_); return out.size(); }
+    size_t mainSize() { std::lock_guard<std::mutex> lock(mutex_); return main.size(); }
+};
+
+}   // namespace Cache
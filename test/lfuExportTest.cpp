@@ -0,0 +1,79 @@
+// LFUCache增量导出: 导出期间结点移入新建的频次列表时不得漏导
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "LFU_CachePolicy.h"
+
+using Cache::LFUCache;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+// 10个频次1的key 1个频次3的key; 第一批导出后未导出的key被访问 移入导出开始时不存在的频次2列表
+static void testKeyMovesToNewListDuringExport()
+{
+    LFUCache<int, std::string> cache(20);
+    for(int key=0; key<10; key++)
+        cache.put(key, std::to_string(key));
+    cache.put(100, "100");
+    std::string value;
+    cache.get(100, value);
+    cache.get(100, value);
+
+    std::set<int> exported;
+    auto add = [&exported](const int& key, const std::string&, int) { exported.insert(key); };
+    check(cache.beginExport(), "beginExport");
+    cache.exportBatch(5, add);
+    check(exported.size() == 5 && exported.count(7) == 0, "first batch exports keys 0-4");
+
+    cache.get(7, value);
+    while(cache.exportBatch(5, add))
+        ;
+    for(int key=0; key<10; key++)
+        check(exported.count(key) == 1, "key " + std::to_string(key) + " exported");
+    check(exported.count(100) == 1, "key 100 exported");
+}
+
+// 频次列表原本为空(而非不存在)时同样不得漏导
+static void testKeyMovesToEmptyListDuringExport()
+{
+    LFUCache<int, std::string> cache(20);
+    std::string value;
+    cache.put(50, "50");
+    cache.get(50, value);           // 建立频次2列表
+    cache.get(50, value);           // 移入频次3列表 频次2列表变空 仍保留
+    for(int key=0; key<10; key++)
+        cache.put(key, std::to_string(key));
+    cache.put(100, "100");
+    cache.get(100, value);
+    cache.get(100, value);
+
+    std::set<int> exported;
+    auto add = [&exported](const int& key, const std::string&, int) { exported.insert(key); };
+    check(cache.beginExport(), "beginExport");
+    cache.exportBatch(5, add);
+    cache.get(8, value);
+    while(cache.exportBatch(5, add))
+        ;
+    for(int key=0; key<10; key++)
+        check(exported.count(key) == 1, "key " + std::to_string(key) + " exported after moving to an empty list");
+    check(exported.count(50) == 1 && exported.count(100) == 1, "keys 50 and 100 exported");
+}
+
+int main()
+{
+    testKeyMovesToNewListDuringExport();
+    testKeyMovesToEmptyListDuringExport();
+    if(failures == 0)
+        std::cout << "lfuExportTest: all passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+// 2Q/LIRS/CLOCK-Pro/SLRU/LRU-2(后向K距离)的行为: 抗扫描、幽灵key再次放入、K距离淘汰顺序 以及随机读写不读到旧值
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+#include "ClockPro_CachePolicy.h"
+#include "LIRS_CachePolicy.h"
+#include "LRUKDistance_CachePolicy.h"
+#include "SLRU_CachePolicy.h"
+#include "TwoQ_CachePolicy.h"
+
+using Cache::ClockProCache;
+using Cache::LIRSCache;
+using Cache::LRUKDistanceCache;
+using Cache::SLRUCache;
+using Cache::TwoQCache;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+// 一次性扫描大量冷key(只放入一次)后 热key仍全部命中
+template<typename CacheType>
+static void checkScanResistant(CacheType& cache, int hotKeys, const std::string& name)
+{
+    for(int key=100000; key<101000; key++)
+        cache.put(key, key);
+    int hits = 0;
+    int value;
+    for(int key=0; key<hotKeys; key++)
+        hits += cache.get(key, value) && value == key;
+    check(hits == hotKeys, name + ": " + std::to_string(hits) + "/" + std::to_string(hotKeys) + " hot keys survive a scan");
+}
+
+// 随机读写删: 命中时必须是最近一次放入的value 条目数不超过容量
+template<typename CacheType>
+static void checkRandomOperations(CacheType& cache, size_t capacity, const std::string& name)
+{
+    std::mt19937 rng(7);
+    std::map<int, int> latest;
+    bool fresh = true;
+    bool bounded = true;
+    for(int i=0; i<200000; i++)
+    {
+        int key = static_cast<int>(rng() % 400);
+        if(rng() % 3 == 0)
+            key %= 20;                                  // 少量热key
+        unsigned op = rng() % 10;
+        int value;
+        if(op < 6)
+        {
+            if(cache.get(key, value))
+                fresh = fresh && latest.count(key) && latest[key] == value;
+            else
+            {
+                cache.put(key, i);
+                latest[key] = i;
+            }
+        }
+        else if(op < 9)
+        {
+            cache.put(key, i);
+            latest[key] = i;
+        }
+        else
+        {
+            cache.remove(key);
+            latest.erase(key);
+        }
+        bounded = bounded && cache.size() <= capacity;
+    }
+    check(fresh, name + ": hits return the latest value");
+    check(bounded, name + ": size stays within capacity");
+}
+
+static void testTwoQ()
+{
+    // A1in目标长度5 幽灵队列长度10
+    TwoQCache<int, int> ghost(20, 10);
+    ghost.put(1, 1);
+    for(int key=10; key<30; key++)
+        ghost.put(key, key);                            // 1被挤出A1in 成为幽灵
+    int value;
+    check(!ghost.get(1, value), "2Q: key pushed out of A1in misses");
+    check(ghost.ghostSize() > 0, "2Q: evicted A1in keys kept as ghosts");
+    size_t mainBefore = ghost.mainSize();
+    ghost.put(1, 2);                                    // 幽灵key再次放入 -> 进入Am
+    check(ghost.mainSize() == mainBefore + 1 && ghost.get(1, value) && value == 2, "2Q: ghost re-admitted into Am");
+
+    // 热key经幽灵再次放入进入Am 之后的扫描只经过A1in/A1out
+    TwoQCache<int, int> scan(20, 40);
+    for(int key=0; key<10; key++)
+        scan.put(key, key);
+    for(int key=1000; key<1020; key++)
+        scan.put(key, key);
+    for(int key=0; key<10; key++)
+        scan.put(key, key);
+    check(scan.mainSize() == 10, "2Q: hot keys admitted into Am");
+    checkScanResistant(scan, 10, "2Q");
+
+    TwoQCache<int, int> random(50);
+    checkRandomOperations(random, 50, "2Q");
+}
+
+static void testLIRS()
+{
+    // 循环长度超过容量: LRU每次都在命中前淘汰 LIRS固定保留LIR部分
+    LIRSCache<int, int> loop(10);
+    int value;
+    int hits = 0;
+    for(int round=0; round<20; round++)
+    {
+        for(int key=0; key<15; key++)
+        {
+            if(loop.get(key, value))
+                hits += round >= 10;
+            else
+                loop.put(key, key);
+        }
+    }
+    check(hits >= 10 * 8, "LIRS: loop larger than capacity keeps hitting the LIR set (" + std::to_string(hits) + " hits)");
+
+    // 非常驻HIR再次放入 重用距离小于栈底LIR -> 直接成为LIR
+    LIRSCache<int, int> ghost(10, 0.2);
+    for(int key=0; key<10; key++)
+        ghost.put(key, key);
+    ghost.put(50, 50);                                  // 淘汰一个HIR 成为非常驻
+    check(ghost.ghostSize() == 1, "LIRS: evicted HIR kept as non-resident in the stack");
+    size_t lirBefore = ghost.lirSize();
+    int evicted = -1;
+    for(int key=0; key<10 && evicted < 0; key++)
+        if(!ghost.get(key, value))
+            evicted = key;
+    check(evicted >= 0, "LIRS: one original key was evicted");
+    ghost.put(evicted, evicted);
+    check(ghost.lirSize() == lirBefore && ghost.get(evicted, value) && value == evicted,
+          "LIRS: re-admitted non-resident key becomes LIR");
+
+    LIRSCache<int, int> scan(20, 0.1);
+    for(int round=0; round<2; round++)
+        for(int key=0; key<15; key++)
+            if(!scan.get(key, value))
+                scan.put(key, key);
+    checkScanResistant(scan, 15, "LIRS");
+
+    LIRSCache<int, int> random(50);
+    checkRandomOperations(random, 50, "LIRS");
+}
+
+static void testClockPro()
+{
+    // 测试期内再次放入的key成为热页 并增大冷页目标数量
+    ClockProCache<int, int> test(10);
+    for(int key=0; key<10; key++)
+        test.put(key, key);
+    for(int key=100; key<105; key++)
+        test.put(key, key);
+    check(test.testSize() > 0, "CLOCK-Pro: evicted cold pages kept as test pages");
+    int value;
+    int evicted = -1;
+    for(int key=0; key<10 && evicted < 0; key++)
+        if(!test.get(key, value))
+            evicted = key;
+    check(evicted >= 0, "CLOCK-Pro: one original key was evicted");
+    size_t hotBefore = test.hotSize();
+    size_t targetBefore = test.coldTargetSize();
+    test.put(evicted, evicted);
+    check(test.hotSize() == hotBefore + 1, "CLOCK-Pro: re-admitted test page becomes hot");
+    check(test.coldTargetSize() > targetBefore, "CLOCK-Pro: re-admission grows the cold target");
+
+    // 被访问两次的key成为热页 一次性扫描不会挤掉它们
+    ClockProCache<int, int> scan(40);
+    for(int round=0; round<3; round++)
+        for(int key=0; key<10; key++)
+            if(!scan.get(key, value))
+                scan.put(key, key);
+    for(int key=1000; key<1100; key++)
+        scan.put(key, key);
+    for(int round=0; round<3; round++)
+        for(int key=0; key<10; key++)
+            if(!scan.get(key, value))
+                scan.put(key, key);
+    checkScanResistant(scan, 10, "CLOCK-Pro");
+
+    ClockProCache<int, int> random(50);
+    checkRandomOperations(random, 50, "CLOCK-Pro");
+}
+
+static void testSLRU()
+{
+    SLRUCache<int, int> promote(10);
+    promote.put(1, 1);
+    int value;
+    check(promote.probationSize() == 1 && promote.protectedSize() == 0, "SLRU: new key enters probation");
+    check(promote.get(1, value) && promote.protectedSize() == 1, "SLRU: hit in probation promotes");
+
+    SLRUCache<int, int> scan(10);
+    for(int key=0; key<8; key++)
+    {
+        scan.put(key, key);
+        scan.get(key, value);
+    }
+    check(scan.protectedSize() == 8, "SLRU: hot keys fill the protected segment");
+    checkScanResistant(scan, 8, "SLRU");
+
+    // 保护段超出时最久未使用的降回试用段 而不是直接淘汰
+    SLRUCache<int, int> demote(10);
+    for(int key=0; key<9; key++)
+    {
+        demote.put(key, key);
+        demote.get(key, value);
+    }
+    check(demote.protectedSize() == 8 && demote.probationSize() == 1, "SLRU: protected overflow demoted to probation");
+    check(demote.get(0, value) && value == 0, "SLRU: demoted key still cached");
+
+    SLRUCache<int, int> random(50);
+    checkRandomOperations(random, 50, "SLRU");
+}
+
+static void testLRUKDistance()
+{
+    int value;
+    // 不足K次访问的后向距离为无穷大 最先淘汰; 都满K次时淘汰倒数第K次访问最早的
+    LRUKDistanceCache<int, int, 2> order(3);
+    order.put(1, 1);
+    order.put(2, 2);
+    order.put(3, 3);
+    order.get(1, value);
+    order.get(2, value);
+    order.put(4, 4);
+    check(!order.contains(3) && order.contains(1) && order.contains(2), "LRU-2: key with one reference evicted first");
+    order.get(4, value);
+    order.put(5, 5);
+    check(!order.contains(1) && order.contains(2) && order.contains(4),
+          "LRU-2: oldest second-to-last reference evicted among full histories");
+
+    // 距离相同(都不足K次)时按LRU
+    LRUKDistanceCache<int, int, 2> ties(2);
+    ties.put(1, 1);
+    ties.put(2, 2);
+    ties.put(3, 3);
+    check(!ties.contains(1) && ties.contains(2), "LRU-2: ties broken by least recent reference");
+
+    // 相关周期内的条目不参与淘汰: 1的距离为无穷大但刚被放入 淘汰周期已过的2
+    LRUKDistanceCache<int, int, 2> period(2, 0, 3);
+    period.put(2, 2);
+    for(int i=0; i<4; i++)
+        period.get(99, value);
+    period.get(2, value);
+    for(int i=0; i<4; i++)
+        period.get(99, value);
+    period.put(1, 1);
+    period.put(3, 3);
+    check(period.contains(1) && !period.contains(2), "LRU-2: entries inside the correlated period are not evicted");
+
+    // 被淘汰的key保留访问历史 再次放入时带着历史 不会被新key先挤掉
+    LRUKDistanceCache<int, int, 2> history(2, 10);
+    history.put(1, 1);
+    history.put(2, 2);
+    history.put(3, 3);                                  // 淘汰1 保留历史
+    check(!history.contains(1) && history.historySize() == 1, "LRU-2: evicted key keeps its history");
+    history.put(1, 1);                                  // 第二次访问 距离有限
+    history.put(4, 4);
+    check(history.contains(1), "LRU-2: re-admitted key with history outlives new keys");
+
+    LRUKDistanceCache<int, int, 2> scan(20);
+    for(int round=0; round<2; round++)
+        for(int key=0; key<10; key++)
+            if(!scan.get(key, value))
+                scan.put(key, key);
+    checkScanResistant(scan, 10, "LRU-2");
+
+    LRUKDistanceCache<int, int, 2> random(50);
+    checkRandomOperations(random, 50, "LRU-2");
+    LRUKDistanceCache<int, int, 3> randomPeriod(50, 100, 20);
+    checkRandomOperations(randomPeriod, 50, "LRU-3 with correlated period");
+}
+
+int main()
+{
+    testTwoQ();
+    testLIRS();
+    testClockPro();
+    testSLRU();
+    testLRUKDistance();
+    if(failures == 0)
+        std::cout << "policyBehaviourTest: all passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// SharedMemoryCache: 容量上限、按名称跨进程打开、布局核对、持锁进程崩溃后的恢复(EOWNERDEAD)
+#include <iostream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SharedMemoryCache.h"
+
+using Cache::SharedMemoryCache;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+// 等待子进程 返回其退出码(异常退出返回-1)
+static int waitChild(pid_t pid)
+{
+    int status = 0;
+    if(waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+        return -1;
+    return WEXITSTATUS(status);
+}
+
+// 总条目数恰为capacity 不按分片向上取整
+static void testCapacityEnforced()
+{
+    const size_t capacities[] = {1, 3, 17, 64};
+    for(size_t capacity : capacities)
+    {
+        SharedMemoryCache<int, int> cache("", capacity, 64, 4);
+        check(cache.ok(), "anonymous mapping");
+        for(int key=0; key<1000; key++)
+            cache.put(key, key);
+        check(cache.size() == capacity, "capacity " + std::to_string(capacity) + " holds " +
+                                        std::to_string(cache.size()) + " entries");
+    }
+}
+
+// 父进程创建具名共享内存 子进程按同名打开 双方看到彼此写入的条目
+static void testNamedAttach(const std::string& name)
+{
+    SharedMemoryCache<int, std::string>::unlink(name);
+    SharedMemoryCache<int, std::string> cache(name, 100, 64, 4);
+    check(cache.ok(), "create named shared memory");
+    for(int key=0; key<50; key++)
+        cache.put(key, "v" + std::to_string(key));
+
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        SharedMemoryCache<int, std::string> attached(name, 100, 64, 4);
+        std::string value;
+        int code = 0;
+        if(!attached.ok())
+            code = 1;
+        else if(!attached.get(7, value) || value != "v7")
+            code = 2;
+        else
+            attached.put(1000, "from child");
+        _exit(code);
+    }
+    check(waitChild(pid) == 0, "child attaches by name and reads the parent's entries");
+    std::string value;
+    check(cache.get(1000, value) && value == "from child", "parent reads the child's entry");
+    check(cache.sharedStats().puts == 51, "shared counters include both processes");
+
+    // 布局不符(容量、槽位大小、分片数)的打开失败 不破坏已有内容
+    SharedMemoryCache<int, std::string> otherCapacity(name, 200, 64, 4);
+    SharedMemoryCache<int, std::string> otherSlot(name, 100, 128, 4);
+    SharedMemoryCache<int, std::string> otherShards(name, 100, 64, 8);
+    check(!otherCapacity.ok() && !otherSlot.ok() && !otherShards.ok(), "layout mismatch rejected");
+    check(!otherCapacity.get(7, value), "rejected mapping misses");
+    check(cache.get(7, value) && value == "v7", "existing contents intact after rejected attaches");
+
+    check(SharedMemoryCache<int, std::string>::unlink(name), "unlink named shared memory");
+}
+
+// 子进程在驱逐回调中(持有分片锁)退出 父进程下次加锁得到EOWNERDEAD 清空该分片后继续使用
+static void testOwnerDeadRecovery()
+{
+    SharedMemoryCache<int, int> cache("", 2, 64, 1);
+    cache.put(1, 1);
+    cache.put(2, 2);
+
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        cache.setEvictionListener([](const int&, const int&) { _exit(0); });
+        cache.put(3, 3);                                // 驱逐1 回调中退出
+        _exit(1);
+    }
+    check(waitChild(pid) == 0, "child died while holding the shard lock");
+    check(cache.size() == 0, "shard reset after the owner died");
+    cache.put(4, 4);
+    int value = 0;
+    check(cache.get(4, value) && value == 4, "cache usable after recovery");
+    check(!cache.get(1, value), "entries of the reset shard are dropped");
+}
+
+int main()
+{
+    testCapacityEnforced();
+    testNamedAttach("/cacheShmTest-" + std::to_string(getpid()));
+    testOwnerDeadRecovery();
+    if(failures == 0)
+        std::cout << "sharedMemoryCacheTest: all passed\n";
+    return failures == 0 ? 0 : 1;
+}
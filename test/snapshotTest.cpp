@@ -0,0 +1,175 @@
+// 快照: LRU/LFU/LRU-K的保存与恢复 以及损坏、截断、伪造条目数、策略不符的文件须恢复失败
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+#include "Snapshot.h"
+
+using Cache::LFUCache;
+using Cache::LRUCache;
+using Cache::LRU_KCache;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+static std::string readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::string& data)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// 恢复后LRU顺序不变: 放入新条目时最久未使用的先被淘汰; 容量较小时保留最近使用的部分
+static void testLruRoundTrip(const std::string& dir)
+{
+    std::string path = dir + "/lru.snap";
+    LRUCache<int, std::string> cache(100);
+    for(int key=0; key<100; key++)
+        cache.put(key, "v" + std::to_string(key));
+    std::string value;
+    cache.get(0, value);                                // 0成为最近使用
+    check(Cache::saveSnapshot(cache, path, 16), "save LRU snapshot");
+
+    LRUCache<int, std::string> restored(100);
+    check(Cache::loadSnapshot(restored, path), "load LRU snapshot");
+    check(restored.size() == 100, "all LRU entries restored");
+    restored.put(1000, "new");                          // 淘汰最久未使用的1
+    check(!restored.get(1, value), "least recently used key evicted first after restore");
+    check(restored.get(0, value) && value == "v0", "recently used key kept with its value");
+
+    LRUCache<int, std::string> smaller(10);
+    check(Cache::loadSnapshot(smaller, path), "load LRU snapshot into smaller cache");
+    check(smaller.get(0, value) && smaller.get(99, value) && !smaller.get(50, value),
+          "smaller cache keeps the most recently used entries");
+}
+
+// 恢复后各条目的访问频次不变: 淘汰频次最低的
+static void testLfuRoundTrip(const std::string& dir)
+{
+    std::string path = dir + "/lfu.snap";
+    LFUCache<int, std::string> cache(10);
+    for(int key=0; key<10; key++)
+        cache.put(key, "v" + std::to_string(key));
+    std::string value;
+    for(int key=1; key<10; key++)                       // 除0外的频次都高于0
+        cache.get(key, value);
+    check(Cache::saveSnapshot(cache, path, 3), "save LFU snapshot");
+
+    LFUCache<int, std::string> restored(10);
+    check(Cache::loadSnapshot(restored, path), "load LFU snapshot");
+    restored.put(100, "new");                           // 淘汰频次最低的0
+    check(!restored.get(0, value), "lowest frequency key evicted after restore");
+    check(restored.get(5, value) && value == "v5", "higher frequency key kept with its value");
+
+    LRUCache<int, std::string> lru(10);
+    check(!Cache::loadSnapshot(lru, path), "LFU snapshot rejected by LRU cache");
+}
+
+// LRU-K只保存主缓存 恢复的条目直接在主缓存中; 与LRUCache的快照互通
+static void testLruKRoundTrip(const std::string& dir)
+{
+    std::string path = dir + "/lruk.snap";
+    LRU_KCache<int, std::string> cache(20, 20, 2);
+    for(int key=0; key<20; key++)
+    {
+        cache.put(key, "v" + std::to_string(key));
+        cache.put(key, "v" + std::to_string(key));     // 第二次访问晋升进主缓存
+    }
+    cache.put(500, "history only");                     // 只访问一次 留在历史记录 不保存
+    check(cache.size() == 20, "LRU-K main cache filled");
+    check(Cache::saveSnapshot(cache, path, 7), "save LRU-K snapshot");
+
+    LRU_KCache<int, std::string> restored(20, 20, 2);
+    check(Cache::loadSnapshot(restored, path), "load LRU-K snapshot");
+    check(restored.size() == 20 && restored.contains(7), "LRU-K entries restored into the main cache");
+    check(!restored.contains(500), "history entries are not saved");
+    std::string value;
+    check(restored.get(7, value) && value == "v7", "restored LRU-K value");
+
+    LRUCache<int, std::string> lru(20);
+    check(Cache::loadSnapshot(lru, path), "LRU-K snapshot loads into LRU cache");
+    check(lru.get(19, value) && value == "v19", "LRU cache restored from LRU-K snapshot");
+}
+
+// 文件头32字节之后是第一个块头: 条目数u32 字节数u32 校验和u64
+static void testCorruptFiles(const std::string& dir)
+{
+    std::string path = dir + "/good.snap";
+    LRUCache<int, std::string> cache(50);
+    for(int key=0; key<50; key++)
+        cache.put(key, "value-" + std::to_string(key));
+    check(Cache::saveSnapshot(cache, path), "save snapshot for corruption tests");
+    std::string good = readFile(path);
+    check(good.size() > 48, "snapshot has a chunk");
+
+    std::string bad = dir + "/bad.snap";
+    LRUCache<int, std::string> target(50);
+
+    std::string flipped = good;
+    flipped[flipped.size() - 3] ^= 0x5a;
+    writeFile(bad, flipped);
+    check(!Cache::loadSnapshot(target, bad), "payload corruption detected by checksum");
+
+    writeFile(bad, good.substr(0, good.size() - 10));
+    check(!Cache::loadSnapshot(target, bad), "truncated file rejected");
+
+    // 伪造条目数(不在校验和内): 块头与文件头同时改为约40亿条 须在打开时拒绝 而不是按此分配内存
+    std::string forged = good;
+    uint32_t hugeEntries = 0xfffffff0u;
+    uint64_t hugeTotal = hugeEntries;
+    std::memcpy(&forged[32], &hugeEntries, sizeof(hugeEntries));
+    std::memcpy(&forged[16], &hugeTotal, sizeof(hugeTotal));
+    writeFile(bad, forged);
+    check(!Cache::loadSnapshot(target, bad), "forged entry count rejected");
+
+    std::string badMagic = good;
+    badMagic[0] = 'X';
+    writeFile(bad, badMagic);
+    check(!Cache::loadSnapshot(target, bad), "bad magic rejected");
+
+    check(!Cache::loadSnapshot(target, dir + "/missing.snap"), "missing file rejected");
+    check(target.size() == 0, "failed loads before any chunk leave the cache empty");
+    std::remove(bad.c_str());
+    std::remove(path.c_str());
+}
+
+int main()
+{
+    char dirTemplate[] = "/tmp/snapshotTest.XXXXXX";
+    const char* dir = mkdtemp(dirTemplate);
+    if(!dir)
+    {
+        std::cerr << "mkdtemp failed\n";
+        return 1;
+    }
+    testLruRoundTrip(dir);
+    testLfuRoundTrip(dir);
+    testLruKRoundTrip(dir);
+    testCorruptFiles(dir);
+    for(const char* name : {"/lru.snap", "/lfu.snap", "/lruk.snap"})
+        std::remove((std::string(dir) + name).c_str());
+    rmdir(dir);
+    if(failures == 0)
+        std::cout << "snapshotTest: all passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// ThreadLocalCache: 一级缓存不返回旧值 线程退出后一级缓存归还复用 实例先于线程释放时不访问已释放的实例
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LRU_CachePolicy.h"
+#include "ThreadLocalCache.h"
+
+using Cache::LRUCache;
+using Cache::Policy;
+using Cache::ThreadLocalCache;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+static std::unique_ptr<ThreadLocalCache<int, int>> makeCache()
+{
+    return std::unique_ptr<ThreadLocalCache<int, int>>(
+        new ThreadLocalCache<int, int>(std::unique_ptr<Policy<int, int>>(new LRUCache<int, int>(1000)), 64));
+}
+
+// 一级命中后其他线程put 不得再读到旧值
+static void testNoStaleReadAfterPut()
+{
+    auto cache = makeCache();
+    cache->put(1, 10);
+    int value = 0;
+    check(cache->get(1, value) && value == 10, "shared hit");
+    check(cache->get(1, value) && value == 10 && cache->localHits() == 1, "local hit");
+    std::thread writer([&cache]() { cache->put(1, 20); });
+    writer.join();
+    check(cache->get(1, value) && value == 20, "put from another thread invalidates the local copy");
+}
+
+// 线程池不断替换线程: 一级缓存数不随线程数增长
+static void testExitedThreadsReturnTheirCache()
+{
+    auto cache = makeCache();
+    for(int key=0; key<100; key++)
+        cache->put(key, key);
+    for(int round=0; round<50; round++)
+    {
+        std::vector<std::thread> threads;
+        for(int t=0; t<4; t++)
+        {
+            threads.emplace_back([&cache]()
+            {
+                int value;
+                for(int key=0; key<100; key++)
+                    cache->get(key, value);
+            });
+        }
+        for(std::thread& thread : threads)
+            thread.join();
+    }
+    check(cache->localCaches() <= 4, "local caches bounded by concurrent threads, got " +
+                                     std::to_string(cache->localCaches()));
+}
+
+// 实例先于线程释放 线程退出时不得访问已释放的实例; 之后在新实例上照常工作
+static void testCacheDestroyedBeforeThreadExits()
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    int stage = 0;
+    auto first = makeCache();
+    first->put(1, 1);
+    bool ok = true;
+    std::thread worker([&]()
+    {
+        int value;
+        ok = first->get(1, value) && value == 1;
+        std::unique_lock<std::mutex> lock(mutex);
+        stage = 1;
+        cond.notify_all();
+        cond.wait(lock, [&]() { return stage == 2; });
+        lock.unlock();
+        auto second = makeCache();
+        second->put(2, 2);
+        ok = ok && second->get(2, value) && value == 2 && second->get(2, value) && second->localHits() == 1;
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&]() { return stage == 1; });
+        first.reset();
+        stage = 2;
+        cond.notify_all();
+    }
+    worker.join();
+    check(ok, "thread keeps working after an instance it used is destroyed");
+}
+
+int main()
+{
+    testNoStaleReadAfterPut();
+    testExitedThreadsReturnTheirCache();
+    testCacheDestroyedBeforeThreadExits();
+    if(failures == 0)
+        std::cout << "threadLocalCacheTest: all passed\n";
+    return failures == 0 ? 0 : 1;
+}
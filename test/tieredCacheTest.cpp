@@ -0,0 +1,148 @@
+// TieredCache/FlashCache: 降级、二级命中、提升、覆盖写、删除 以及不得改动目录中已有的文件
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+#include "LRU_CachePolicy.h"
+#include "TieredCache.h"
+
+using Cache::FlashCache;
+using Cache::LRUCache;
+using Cache::TieredCache;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+static std::unique_ptr<TieredCache<int, std::string>> makeCache(const std::string& dir, int capacity)
+{
+    return std::unique_ptr<TieredCache<int, std::string>>(new TieredCache<int, std::string>(
+        std::unique_ptr<LRUCache<int, std::string>>(new LRUCache<int, std::string>(capacity)), dir, 64 << 10, 1 << 10));
+}
+
+// 一级驱逐的条目降级进闪存 二级命中后从闪存取出并提升回一级
+static void testDemoteAndPromote(const std::string& dir)
+{
+    auto cache = makeCache(dir, 2);
+    check(cache->flashTier().ok(), "flash tier opened");
+    cache->put(1, "one");
+    cache->put(2, "two");
+    cache->put(3, "three");                             // 驱逐1 -> 降级
+    check(cache->flashTier().size() == 1, "evicted key demoted to flash");
+
+    std::string value;
+    check(cache->get(1, value) && value == "one", "L2 hit returns demoted value");
+    check(cache->flashTier().size() == 1, "promoted key taken out of flash (and 2 demoted in its place)");
+    check(cache->memoryTier().get(1, value) && value == "one", "L2 hit promoted back to memory");
+    check(!cache->get(42, value), "key never put misses");
+}
+
+// 区域写出后从文件读取
+static void testHitFromFile(const std::string& dir)
+{
+    auto cache = makeCache(dir, 1);
+    const int keys = 200;                               // 远超一个区域(1KB) 已写出的区域从文件读取
+    for(int key=0; key<keys; key++)
+        cache->put(key, "value-" + std::to_string(key));
+    cache->flashTier().waitFlushed();
+    check(cache->flashTier().stats().bytesWritten > 0, "regions flushed to file");
+
+    int hits = 0;
+    bool correct = true;
+    std::string value;
+    for(int key=0; key<keys - 1; key++)
+    {
+        if(cache->get(key, value))
+        {
+            hits++;
+            correct = correct && value == "value-" + std::to_string(key);
+        }
+    }
+    check(hits > 0, "some demoted keys hit in flash");
+    check(correct, "flash hits return the demoted values");
+}
+
+// put使闪存中的旧值失效 不会把旧值提升回来
+static void testOverwriteInvalidatesFlash(const std::string& dir)
+{
+    auto cache = makeCache(dir, 2);
+    cache->put(1, "old");
+    cache->put(2, "two");
+    cache->put(3, "three");                             // 1的旧值降级
+    cache->put(1, "new");
+    std::string value;
+    check(cache->get(1, value) && value == "new", "overwrite wins over demoted value");
+    cache->put(4, "four");
+    cache->put(5, "five");                              // 1的新值降级
+    check(cache->get(1, value) && value == "new", "re-demoted overwrite returns the new value");
+}
+
+static void testRemove(const std::string& dir)
+{
+    FlashCache<int, std::string> flash(dir, 64 << 10, 1 << 10);
+    flash.insert(1, "one");
+    flash.insert(2, "two");
+    flash.remove(1);
+    std::string value;
+    check(!flash.get(1, value), "removed key misses");
+    check(flash.get(2, value) && value == "two", "other key still hits");
+    check(flash.size() == 1, "size after remove");
+}
+
+// 目录中已有的文件不被截断或删除; 传入普通文件路径时打开失败而不是覆盖它
+static void testExistingFilesUntouched(const std::string& dir)
+{
+    std::string path = dir + "/keep.txt";
+    {
+        std::ofstream out(path);
+        out << "precious";
+    }
+    {
+        FlashCache<int, std::string> flash(dir, 64 << 10, 1 << 10);
+        check(flash.ok(), "flash cache opened in directory");
+    }
+    {
+        FlashCache<int, std::string> flash(path, 64 << 10, 1 << 10);
+        check(!flash.ok(), "regular file path rejected");
+        flash.insert(1, "one");
+        std::string value;
+        check(!flash.get(1, value), "failed flash tier drops inserts");
+    }
+    std::ifstream in(path);
+    std::string content;
+    in >> content;
+    check(content == "precious", "existing file left intact");
+    std::remove(path.c_str());
+}
+
+int main()
+{
+    char dirTemplate[] = "/tmp/tieredCacheTest.XXXXXX";
+    const char* dir = mkdtemp(dirTemplate);
+    if(!dir)
+    {
+        std::cerr << "mkdtemp failed\n";
+        return 1;
+    }
+    testDemoteAndPromote(dir);
+    testHitFromFile(dir);
+    testOverwriteInvalidatesFlash(dir);
+    testRemove(dir);
+    testExistingFilesUntouched(dir);
+    rmdir(dir);
+    if(failures == 0)
+        std::cout << "tieredCacheTest: all passed\n";
+    return failures == 0 ? 0 : 1;
+}
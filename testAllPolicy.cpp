@@ -1,11 +1,21 @@
 #include "include/CachePolicy.h"
 #include "include/LRU_CachePolicy.h"
 #include "include/LFU_CachePolicy.h"
+#include "include/CompactLRU_CachePolicy.h"
+#include "include/SegmentLRU_CachePolicy.h"
+#include "include/LRUKDistance_CachePolicy.h"
+#include "include/TwoQ_CachePolicy.h"
+#include "include/LIRS_CachePolicy.h"
+#include "include/ClockPro_CachePolicy.h"
+#include "include/SLRU_CachePolicy.h"
+#include "bench/Belady.h"
+#include "bench/Workload.h"
 #include "data/SQLite.h"
 #include<iostream>
 #include<chrono>
 #include<ctime>
-#include<random>
+#include<functional>
+#include<string>
 #include<vector>
 #include<iomanip>
 
@@ -13,25 +23,124 @@
 using namespace Cache;
 using std::string, std::to_string, std::cout;
 
-static std::vector<string> cacheNames = {"LRU", "LRU-K", "LRU-Hash", "LFU", "LFU-Hash"};
+static std::vector<string> cacheNames = {"LRU", "LRU-Compact", "LRU-Segment", "LRU-K", "LRU-2", "2Q", "LIRS", "CLOCK-Pro", "SLRU", "LRU-Hash", "LFU", "LFU-Hash"};
 
 
-void printResult(const int capacity, 
-                    const std::vector<unsigned int>& getTimes, 
-                    const std::vector<unsigned int>& hitTimes)
+// 从数据库加载页 -> 查询结果为空视为加载失败
+static bool loadFromSource(SQL_l& source, int key, string& value)
+{
+    value = source.Query(to_string(key), "key", "value", "Pages");
+    return !value.empty();
+}
+
+// 打印某类操作的延迟分位数(纳秒)
+void printLatency(const string& opName, const HistogramSnapshot& latency)
+{
+    if(latency.count == 0)
+        return;
+    cout << opName << "延迟(ns) p50: " << latency.percentile(50)
+         << "  p99: " << latency.percentile(99)
+         << "  p99.9: " << latency.percentile(99.9)
+         << "  max: " << latency.max << "\n";
+}
+
+// 一个测试场景的负载: 预热key + 预先生成的操作序列
+// 由固定种子生成一次 所有策略回放完全相同的序列 生成开销不计入计时
+struct Scenario
+{
+    std::vector<int> warmupKeys;
+    std::vector<Bench::Operation> operations;
+};
+
+// 默认种子 可由命令行第一个参数覆盖
+static uint64_t workloadSeed = 20240601;
+
+// OPT(Belady最优替换)在同一份负载上的命中率 -> 所有策略的上界
+static Bench::BeladySimulator::Result optimalResult(const int capacity, const Scenario& scenario)
+{
+    Bench::BeladySimulator belady;
+    for(int key : scenario.warmupKeys)
+        belady.add(key, false);
+    for(const Bench::Operation& op : scenario.operations)
+        belady.add(op.key, !op.isPut);
+    belady.finalize();
+    return belady.simulate(capacity);
+}
+
+void printOptimal(const int capacity, const Scenario& scenario)
+{
+    Bench::BeladySimulator::Result result = optimalResult(capacity, scenario);
+    cout << "============== OPT: ==============\n";
+    cout << "缓存大小: " << capacity << "\n";
+    cout << "OPT: 命中率: " << std::fixed << std::setprecision(2) << result.hitRatio() * 100 << "%";
+    cout << "(" << result.hits << "/" << result.requests << ")" << std::endl;
+    cout << "===================================\n" << std::endl;
+}
+
+void printResult(const int capacity, const std::vector<Cache::Policy<int, string>*>& caches,
+                 const std::vector<double>& seconds, const size_t operations)
 {
     for(int i=0; i<cacheNames.size(); i++)
     {
+        CacheStats stats = caches[i]->stats();
         cout << "============== " << cacheNames[i] << ": ==============\n";
         cout << "缓存大小: " << capacity << "\n";
-        double hitRate = (double)hitTimes[i] / getTimes[i] * 100;
+        double hitRate = stats.hitRate() * 100;
         cout << cacheNames[i] << ": " << "命中率: " << std::fixed << std::setprecision(2) << hitRate << "%";
-        cout << "(" << hitTimes[i] << "/" << getTimes[i] << ")" << std::endl;
+        cout << "(" << stats.hits << "/" << stats.hits + stats.misses << ")" << std::endl;
+        cout << "放入: " << stats.puts << "  驱逐: " << stats.evictions
+             << "  加载: " << stats.loadSuccesses << "(失败" << stats.loadFailures << ")"
+             << "  平均加载耗时: " << std::setprecision(1) << stats.averageLoadNanos() / 1000 << "us" << std::endl;
+        cout << "耗时: " << std::setprecision(3) << seconds[i] * 1000 << "ms  吞吐: "
+             << std::setprecision(0) << operations / seconds[i] << " ops/s" << std::endl;
+        printLatency("get ", caches[i]->latency(LatencyRecorder::Get));
+        printLatency("put ", caches[i]->latency(LatencyRecorder::Put));
+        printLatency("load", caches[i]->latency(LatencyRecorder::Load));
         cout << "===================================\n" << std::endl;
     }
 
 }
 
+// 对每个策略回放同一份负载: 先按预热key放入初始值 再计时执行操作序列
+// 读操作命中则不变 未命中则从数据库加载后放入; 写操作的value由场景根据操作构造
+// maintenance非空时每maintenanceInterval次操作调用一次(如分片再平衡) 按操作数而非时间触发 保证可复现
+template<typename WarmupValue, typename PutValue>
+void runScenario(SQL_l& source, const int capacity, const std::vector<Cache::Policy<int, string>*>& caches,
+                 const Scenario& scenario, WarmupValue&& warmupValue, PutValue&& putValue,
+                 const std::function<void(Cache::Policy<int, string>*)>& maintenance = nullptr,
+                 const size_t maintenanceInterval = 1000)
+{
+    std::vector<double> seconds(caches.size(), 0);
+    for(int i=0; i<caches.size(); i++)
+    {
+        Cache::Policy<int, string>* cache = caches[i];
+        cache->enableLatency();
+        for(int key : scenario.warmupKeys)
+            cache->put(key, warmupValue(key));
+
+        auto begin = std::chrono::steady_clock::now();
+        for(size_t n=0; n<scenario.operations.size(); n++)
+        {
+            const Bench::Operation& op = scenario.operations[n];
+            if(op.isPut)
+                cache->put(op.key, putValue(op));
+            else
+            {
+                string value;
+                cache->getOrLoad(op.key, value, [&source](int key, string& value)
+                {
+                    return loadFromSource(source, key, value);
+                });
+            }
+            if(maintenance && (n + 1) % maintenanceInterval == 0)
+                maintenance(cache);
+        }
+        seconds[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    printResult(capacity, caches, seconds, scenario.operations.size());
+    printOptimal(capacity, scenario);
+}
+
 void testHotDataAccess(SQL_l& source)
 {
     cout << "\n=== 测试场景1: 热点数据访问测试 ===\n" << std::endl;
@@ -42,78 +151,62 @@ void testHotDataAccess(SQL_l& source)
     const int hotKeys = 20;
     const int coldKeys = 5000;
 
-    // 读次数与命中次数 -> 求命中率
-    // 结果存储
-    std::vector<unsigned int> getTimes(5, 0);
-    std::vector<unsigned int> hitTimes(5, 0);
+    // 生成负载: 插入热数据预热缓存 然后交替put get
+    Scenario scenario;
+    Bench::Random rng(workloadSeed);
+    for(int key=0; key < hotKeys; key++)
+        scenario.warmupKeys.push_back(key);
+    scenario.operations.reserve(operatorTimes);
+    for(int op=0; op < operatorTimes; op++)
+    {
+        Bench::Operation operation;
+        // 30%概率写    70%概率读
+        operation.isPut = rng.nextBounded(100) < 30;
+        // 70%概率热数据    30%冷数据
+        bool isHot = rng.nextBounded(100) < 70;
+        if(isHot)
+            operation.key = rng.nextBounded(hotKeys);
+        else
+            operation.key = rng.nextBounded(coldKeys) + hotKeys;
+        operation.tag = op % 100;
+        scenario.operations.push_back(operation);
+    }
 
     // 初始化待测缓存
     LRUCache<int, string> LRU_cache(capacity);
+    CompactLRUCache<int, string> LRU_Compact_cache(capacity);
+    // value存放在1KB的段中 预算按每条256字节给足 淘汰只受条目数限制
+    SegmentLRUCache<int, string> LRU_Segment_cache(capacity, capacity * 256, 1024);
     // 为LRU-K设置合适的参数：
     // - 主缓存容量与其他算法相同
     // - 历史记录容量设为可能访问的所有键数量
     // - k=2表示数据被访问2次后才会进入缓存，适合区分热点和冷数据
     LRU_KCache<int, string> LRU_K_cache(capacity, hotKeys+coldKeys, 2);
+    // LRU-2: 按后向2距离淘汰 保留访问历史的key数与LRU-K的历史记录相同
+    LRUKDistanceCache<int, string, 2> LRU_2_cache(capacity, hotKeys+coldKeys);
+    // 2Q: A1in占25% 幽灵队列默认为容量的一半
+    TwoQCache<int, string> TwoQ_cache(capacity);
+    // LIRS: 常驻HIR占1%(至少1条) 非常驻HIR至多为容量的2倍
+    LIRSCache<int, string> LIRS_cache(capacity);
+    ClockProCache<int, string> ClockPro_cache(capacity);
+    // SLRU: 保护段占80%
+    SLRUCache<int, string> SLRU_cache(capacity);
     LRU_HashCache<int, string> LRU_Hash_cache(capacity, 4);
 
     LFUCache<int, string> LFUcache(capacity);
     LFU_HashCache<int, string> LFU_Hash_cache(capacity, 4);
     
-    std::vector<Cache::Policy<int, string>*> caches = {&LRU_cache, &LRU_K_cache, &LRU_Hash_cache, &LFUcache, &LFU_Hash_cache};
-    
-
-    // 策略名称计数器
-    for(int i=0; i<caches.size(); i++)
-    {
-        // 随机生成key
-        std::random_device rd;
-        std::mt19937 gen(rd());
+    std::vector<Cache::Policy<int, string>*> caches = {&LRU_cache, &LRU_Compact_cache, &LRU_Segment_cache, &LRU_K_cache, &LRU_2_cache, &TwoQ_cache, &LIRS_cache, &ClockPro_cache, &SLRU_cache, &LRU_Hash_cache, &LFUcache, &LFU_Hash_cache};
 
-        //  插入热数据预热缓存
-        for(int key=0; key < hotKeys;key++)
-        {
-            string value = to_string(key);
-            caches[i]->put(key, value);
-        }
-        // 交替put get
-        for(int op=0; op < operatorTimes; op++)
+    // 热点在分片间分布不均 -> 每1000次操作按幽灵命中在分片间移动容量
+    runScenario(source, capacity, caches, scenario,
+        [](int key) { return to_string(key); },
+        [](const Bench::Operation& op) { return to_string(op.key) + "_" + to_string(op.tag); },
+        [&LRU_Hash_cache](Cache::Policy<int, string>* cache)
         {
-            // 30%概率写    70%概率读
-            bool isPut = (gen() % 100 < 30);
-            int key;
-
-            // 70%概率热数据    30%冷数据
-            bool isHot = (gen() % 100 < 70);
-            if(isHot)
-                key = gen() % hotKeys;
-            else
-                key = gen() % coldKeys + hotKeys;
-            
-            // 如果为写操作
-            if(isPut)
-            {
-                // cout << "put:" << key << std::endl;
-                string value = to_string(key) + "_" + to_string(op % 100);
-                caches[i]->put(key, value);
-            }
-            // 如果为读操作
-            else
-            {
-                getTimes[i]++;
-                string value;
-                // 命中则不变
-                if(caches[i]->get(key, value))
-                    hitTimes[i]++;
-                // 未命中则放入
-                else
-                {
-                    value = source.Query(to_string(key), "key", "value", "Pages");
-                    caches[i]->put(key, value);
-                }
-            }
-        }
-    }
-    printResult(capacity, getTimes, hitTimes);
+            if(cache == &LRU_Hash_cache)
+                LRU_Hash_cache.rebalance();
+        });
 }
 
 void testLoopPattern(SQL_l& source) 
@@ -123,81 +216,66 @@ void testLoopPattern(SQL_l& source)
     const int capacity = 50;          
     const int loopSize = 500;        
     const int operations = 200000;    
+
+    // 生成负载: 先预热一部分数据（只加载20%的数据） 再交替进行读写操作，模拟真实场景
+    Scenario scenario;
+    Bench::Random rng(workloadSeed + 1);
+    for (int key = 0; key < loopSize / 5; ++key) 
+        scenario.warmupKeys.push_back(key);
+    scenario.operations.reserve(operations);
+    // 设置循环扫描的当前位置
+    int current_pos = 0;
+    for (int op = 0; op < operations; ++op) 
+    {
+        Bench::Operation operation;
+        // 20%概率是写操作，80%概率是读操作
+        operation.isPut = rng.nextBounded(100) < 20;
+        // 按照不同模式选择键
+        // 60%顺序扫描
+        if(op % 100 < 60) 
+        {
+            operation.key = current_pos;
+            current_pos = (current_pos + 1) % loopSize;
+        } 
+        // 30%随机跳跃
+        else if(op % 100 < 90)          
+            operation.key = rng.nextBounded(loopSize);
+        // 10%访问范围外数据
+        else  
+            operation.key = loopSize + rng.nextBounded(loopSize);
+        operation.tag = op % 100;
+        scenario.operations.push_back(operation);
+    }
     
-    std::vector<unsigned int> hitTimes(5, 0);
-    std::vector<unsigned int> getTimes(5, 0);
     // 初始化待测缓存
     LRUCache<int, string> LRU_cache(capacity);
+    CompactLRUCache<int, string> LRU_Compact_cache(capacity);
+    // value存放在1KB的段中 预算按每条256字节给足 淘汰只受条目数限制
+    SegmentLRUCache<int, string> LRU_Segment_cache(capacity, capacity * 256, 1024);
     // 为LRU-K设置合适的参数：
     // - 主缓存容量与其他算法相同
     // - 历史记录容量设为可能访问的所有键数量
     // - k=2表示数据被访问2次后才会进入缓存，适合区分热点和冷数据
     LRU_KCache<int, string> LRU_K_cache(capacity, loopSize * 2, 2);
+    // LRU-2: 按后向2距离淘汰 保留访问历史的key数与LRU-K的历史记录相同
+    LRUKDistanceCache<int, string, 2> LRU_2_cache(capacity, loopSize * 2);
+    // 2Q: A1in占25% 幽灵队列默认为容量的一半
+    TwoQCache<int, string> TwoQ_cache(capacity);
+    // LIRS: 常驻HIR占1%(至少1条) 非常驻HIR至多为容量的2倍
+    LIRSCache<int, string> LIRS_cache(capacity);
+    ClockProCache<int, string> ClockPro_cache(capacity);
+    // SLRU: 保护段占80%
+    SLRUCache<int, string> SLRU_cache(capacity);
     LRU_HashCache<int, string> LRU_Hash_cache(capacity, 4);
 
     LFUCache<int, string> LFUcache(capacity);
     LFU_HashCache<int, string> LFU_Hash_cache(capacity, 4);
 
-    std::vector<Cache::Policy<int, string>*> caches = {&LRU_cache, &LRU_K_cache, &LRU_Hash_cache, &LFUcache, &LFU_Hash_cache};
-
-
-
-    // 为每种缓存算法运行相同的测试
-    for (int i = 0; i < caches.size(); ++i) 
-    {
-        // 随机生成key
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        // 先预热一部分数据（只加载20%的数据）
-        for (int key = 0; key < loopSize / 5; ++key) 
-        {
-            std::string value = "loop" + std::to_string(key);
-            caches[i]->put(key, value);
-        }
-        // 设置循环扫描的当前位置
-        int current_pos = 0;
+    std::vector<Cache::Policy<int, string>*> caches = {&LRU_cache, &LRU_Compact_cache, &LRU_Segment_cache, &LRU_K_cache, &LRU_2_cache, &TwoQ_cache, &LIRS_cache, &ClockPro_cache, &SLRU_cache, &LRU_Hash_cache, &LFUcache, &LFU_Hash_cache};
 
-        // 交替进行读写操作，模拟真实场景
-        for (int op = 0; op < operations; ++op) 
-        {
-            // 20%概率是写操作，80%概率是读操作
-            bool isPut = (gen() % 100 < 20);
-            int key;
-            // 按照不同模式选择键
-            // 60%顺序扫描
-            if(op % 100 < 60) 
-            {
-                key = current_pos;
-                current_pos = (current_pos + 1) % loopSize;
-            } 
-            // 30%随机跳跃
-            else if(op % 100 < 90)          
-                key = gen() % loopSize;
-            // 10%访问范围外数据
-            else  
-                key = loopSize + (gen() % loopSize);
-            if(isPut) 
-            {
-                // 执行put操作，更新数据
-                std::string value = "loop" + std::to_string(key) + "_v" + std::to_string(op % 100);
-                caches[i]->put(key, value);
-            } 
-            else 
-            {
-                std::string value;
-                getTimes[i]++;
-                // 执行get操作并记录命中情况
-                if(caches[i]->get(key, value)) 
-                    hitTimes[i]++;
-                else
-                {
-                    value = source.Query(to_string(key), "key", "value", "Pages");
-                    caches[i]->put(key, value);
-                }
-            }
-        }
-    }
-    printResult(capacity, getTimes, hitTimes);
+    runScenario(source, capacity, caches, scenario,
+        [](int key) { return "loop" + to_string(key); },
+        [](const Bench::Operation& op) { return "loop" + to_string(op.key) + "_v" + to_string(op.tag); });
 }
 
 void testWorkloadShift(SQL_l& source) 
@@ -207,110 +285,98 @@ void testWorkloadShift(SQL_l& source)
     const int capacity = 30;            // 缓存容量
     const int operations = 80000;       // 总操作次数
     const int phaseLenth = operations / 5;  // 每个阶段的长度
-    
-    // 读次数与命中次数 -> 求命中率
-    // 结果存储
-    std::vector<unsigned int> getTimes(5, 0);
-    std::vector<unsigned int> hitTimes(5, 0);
 
+    // 生成负载: 先预热缓存，只插入少量初始数据 再进行多阶段测试，每个阶段有不同的访问模式
+    Scenario scenario;
+    Bench::Random rng(workloadSeed + 2);
+    for (int key = 0; key < 30; ++key)
+        scenario.warmupKeys.push_back(key);
+    scenario.operations.reserve(operations);
+    for (int op = 0; op < operations; ++op) {
+        // 确定当前阶段
+        int phase = op / phaseLenth;
+        
+        // 每个阶段的读写比例不同 
+        int putProbability;
+        switch (phase) {
+            case 0: putProbability = 15; break;  // 阶段1: 热点访问，15%写入更合理
+            case 1: putProbability = 30; break;  // 阶段2: 大范围随机，写比例为30%
+            case 2: putProbability = 10; break;  // 阶段3: 顺序扫描，10%写入保持不变
+            case 3: putProbability = 25; break;  // 阶段4: 局部性随机，微调为25%
+            case 4: putProbability = 20; break;  // 阶段5: 混合访问，调整为20%
+            default: putProbability = 20;
+        }
+        
+        // 确定是读还是写操作
+        Bench::Operation operation;
+        operation.isPut = rng.nextBounded(100) < putProbability;
+        operation.tag = phase;
+        
+        // 根据不同阶段选择不同的访问模式生成key - 优化后的访问范围
+        if (op < phaseLenth) {  // 阶段1: 热点访问 - 热点数量5，使热点更集中
+            operation.key = rng.nextBounded(5);
+        } else if (op < phaseLenth * 2) {  // 阶段2: 大范围随机 - 范围400，更适合30大小的缓存
+            operation.key = rng.nextBounded(400);
+        } else if (op < phaseLenth * 3) {  // 阶段3: 顺序扫描 - 保持100个键
+            operation.key = (op - phaseLenth * 2) % 100;
+        } else if (op < phaseLenth * 4) {  // 阶段4: 局部性随机 - 优化局部性区域大小
+            // 产生5个局部区域，每个区域大小为15个键，与缓存大小20接近但略小
+            int locality = (op / 800) % 5;  // 调整为5个局部区域
+            operation.key = locality * 15 + rng.nextBounded(15);  // 每区域15个键
+        } else {  // 阶段5: 混合访问 - 增加热点访问比例
+            int r = rng.nextBounded(100);
+            if (r < 40) {  // 40%概率访问热点（从30%增加）
+                operation.key = rng.nextBounded(5);  // 5个热点键
+            } else if (r < 70) {  // 30%概率访问中等范围
+                operation.key = 5 + rng.nextBounded(45);  // 缩小中等范围为50个键
+            } else {  // 30%概率访问大范围（从40%减少）
+                operation.key = 50 + rng.nextBounded(350);  // 大范围也相应缩小
+            }
+        }
+        scenario.operations.push_back(operation);
+    }
+    
     // 初始化待测缓存
     LRUCache<int, string> LRU_cache(capacity);
+    CompactLRUCache<int, string> LRU_Compact_cache(capacity);
+    // value存放在1KB的段中 预算按每条256字节给足 淘汰只受条目数限制
+    SegmentLRUCache<int, string> LRU_Segment_cache(capacity, capacity * 256, 1024);
     // 为LRU-K设置合适的参数：
     // - 主缓存容量与其他算法相同
     // - 历史记录容量设为可能访问的所有键数量
     // - k=2表示数据被访问2次后才会进入缓存，适合区分热点和冷数据
     LRU_KCache<int, string> LRU_K_cache(capacity, 500, 2);
+    // LRU-2: 按后向2距离淘汰 保留访问历史的key数与LRU-K的历史记录相同
+    LRUKDistanceCache<int, string, 2> LRU_2_cache(capacity, 500);
+    // 2Q: A1in占25% 幽灵队列默认为容量的一半
+    TwoQCache<int, string> TwoQ_cache(capacity);
+    // LIRS: 常驻HIR占1%(至少1条) 非常驻HIR至多为容量的2倍
+    LIRSCache<int, string> LIRS_cache(capacity);
+    ClockProCache<int, string> ClockPro_cache(capacity);
+    // SLRU: 保护段占80%
+    SLRUCache<int, string> SLRU_cache(capacity);
     LRU_HashCache<int, string> LRU_Hash_cache(capacity, 4);
 
     LFUCache<int, string> LFUcache(capacity);
     LFU_HashCache<int, string> LFU_Hash_cache(capacity, 4);
     
-    std::vector<Cache::Policy<int, string>*> caches = {&LRU_cache, &LRU_K_cache, &LRU_Hash_cache, &LFUcache, &LFU_Hash_cache};
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    // 为每种缓存算法运行相同的测试
-    for (int i = 0; i < caches.size(); ++i) { 
-        // 先预热缓存，只插入少量初始数据
-        for (int key = 0; key < 30; ++key) {
-            std::string value = "init" + std::to_string(key);
-            caches[i]->put(key, value);
-        }
-        
-        // 进行多阶段测试，每个阶段有不同的访问模式
-        for (int op = 0; op < operations; ++op) {
-            // 确定当前阶段
-            int phase = op / phaseLenth;
-            
-            // 每个阶段的读写比例不同 
-            int putProbability;
-            switch (phase) {
-                case 0: putProbability = 15; break;  // 阶段1: 热点访问，15%写入更合理
-                case 1: putProbability = 30; break;  // 阶段2: 大范围随机，写比例为30%
-                case 2: putProbability = 10; break;  // 阶段3: 顺序扫描，10%写入保持不变
-                case 3: putProbability = 25; break;  // 阶段4: 局部性随机，微调为25%
-                case 4: putProbability = 20; break;  // 阶段5: 混合访问，调整为20%
-                default: putProbability = 20;
-            }
-            
-            // 确定是读还是写操作
-            bool isPut = (gen() % 100 < putProbability);
-            
-            // 根据不同阶段选择不同的访问模式生成key - 优化后的访问范围
-            int key;
-            if (op < phaseLenth) {  // 阶段1: 热点访问 - 热点数量5，使热点更集中
-                key = gen() % 5;
-            } else if (op < phaseLenth * 2) {  // 阶段2: 大范围随机 - 范围400，更适合30大小的缓存
-                key = gen() % 400;
-            } else if (op < phaseLenth * 3) {  // 阶段3: 顺序扫描 - 保持100个键
-                key = (op - phaseLenth * 2) % 100;
-            } else if (op < phaseLenth * 4) {  // 阶段4: 局部性随机 - 优化局部性区域大小
-                // 产生5个局部区域，每个区域大小为15个键，与缓存大小20接近但略小
-                int locality = (op / 800) % 5;  // 调整为5个局部区域
-                key = locality * 15 + (gen() % 15);  // 每区域15个键
-            } else {  // 阶段5: 混合访问 - 增加热点访问比例
-                int r = gen() % 100;
-                if (r < 40) {  // 40%概率访问热点（从30%增加）
-                    key = gen() % 5;  // 5个热点键
-                } else if (r < 70) {  // 30%概率访问中等范围
-                    key = 5 + (gen() % 45);  // 缩小中等范围为50个键
-                } else {  // 30%概率访问大范围（从40%减少）
-                    key = 50 + (gen() % 350);  // 大范围也相应缩小
-                }
-            }
-            
-            if (isPut) 
-            {
-                // 执行写操作
-                string value = "value" + to_string(key) + "_p" + to_string(phase);
-                caches[i]->put(key, value);
-            } 
-            else 
-            {
-                // 执行读操作并记录命中情况
-                string value;
-                getTimes[i]++;
-                if (caches[i]->get(key, value))
-                    hitTimes[i]++;
-                else
-                {
-                    value = source.Query(to_string(key), "key", "value", "Pages");
-                    caches[i]->put(key, value);
-                }
-            }
-        }
-    }
+    std::vector<Cache::Policy<int, string>*> caches = {&LRU_cache, &LRU_Compact_cache, &LRU_Segment_cache, &LRU_K_cache, &LRU_2_cache, &TwoQ_cache, &LIRS_cache, &ClockPro_cache, &SLRU_cache, &LRU_Hash_cache, &LFUcache, &LFU_Hash_cache};
 
-    printResult(capacity, getTimes, hitTimes);
+    runScenario(source, capacity, caches, scenario,
+        [](int key) { return "init" + to_string(key); },
+        [](const Bench::Operation& op) { return "value" + to_string(op.key) + "_p" + to_string(op.tag); });
 }
 
-int main()
+// 用法: Cache [seed]    同一种子产生完全相同的负载与命中率
+int main(int argc, char** argv)
 {
+    if(argc > 1)
+        workloadSeed = std::stoull(argv[1]);
     cout << "hello world!" << std::endl;
     cout << std::thread::hardware_concurrency() << std::endl;
     // 初始化数据库
     SQL_l sql("source.db");
+    cout << "负载种子: " << workloadSeed << std::endl;
 
     sql.executeQuery("CREATE TABLE IF NOT EXISTS Pages (id INTEGER PRIMARY KEY AUTOINCREMENT, key INTEGER unique, value TEXT);");
     // for(int i=0;i < 5020; i++)